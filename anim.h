@@ -0,0 +1,315 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include "raylib.h"
+#include <math.h>
+#include <stdbool.h>
+
+#define ANIM_MAX_FRAMES 32
+#define ANIM_MAX_INSTANCES 32768
+#define ANIM_NONE -1
+
+typedef enum
+{
+    ANIM_ONE_SHOT,
+    ANIM_LOOP
+} AnimMode;
+
+/* Values a clip drives on the actor playing it, besides its frame. */
+typedef enum
+{
+    ANIM_TRACK_OFFSET_X,
+    ANIM_TRACK_ALPHA,
+    ANIM_TRACK_COUNT
+} AnimTrack;
+
+typedef enum
+{
+    ANIM_CURVE_NONE,
+    ANIM_CURVE_ARC,  /* amount * sin(progress * pi): out and back */
+    ANIM_CURVE_BLINK /* amount on even steps of rate per second left, 1 otherwise */
+} AnimCurve;
+
+typedef struct
+{
+    AnimCurve curve;
+    float amount;
+    float rate;
+} AnimTrackDef;
+
+/* One row of a clip table. frames == 0 splits the sprite into square frames;
+   frameTimes, when given, holds one duration per frame and replaces the even
+   split of duration. */
+typedef struct
+{
+    int sprite;
+    int frames;
+    float duration;
+    const float *frameTimes;
+    AnimMode mode;
+    AnimTrackDef tracks[ANIM_TRACK_COUNT];
+} AnimClipDef;
+
+/* A clip definition resolved against the sprite it plays, with source rects
+   relative to the sprite. sprite is -1 for clips that only drive tracks. */
+typedef struct
+{
+    int sprite;
+    int frameCount;
+    Rectangle frames[ANIM_MAX_FRAMES];
+    float frameTime[ANIM_MAX_FRAMES];
+    float duration;
+    AnimMode mode;
+    AnimTrackDef tracks[ANIM_TRACK_COUNT];
+} AnimClip;
+
+/* Playing instances as parallel arrays packed in [0, count), so a tick only
+   walks active animations. Handles carry a generation in their high bits;
+   a finished one-shot frees its id and any handle still pointing at it
+   simply stops matching. */
+typedef struct
+{
+    const AnimClip *clips;
+    int count;
+    int clip[ANIM_MAX_INSTANCES];
+    float left[ANIM_MAX_INSTANCES];
+    float frameTime[ANIM_MAX_INSTANCES];
+    int frame[ANIM_MAX_INSTANCES];
+
+    int idOf[ANIM_MAX_INSTANCES];
+    int slotOf[ANIM_MAX_INSTANCES];
+    int generation[ANIM_MAX_INSTANCES];
+    int freeIds[ANIM_MAX_INSTANCES];
+    int freeCount;
+    int nextId;
+} AnimPool;
+
+/* strip is the sprite's rect in the atlas, or all zero when the sprite is
+   not loaded; the clip then keeps its timing with one empty frame. */
+static inline void AnimClipResolve(AnimClip *clip, const AnimClipDef *def, Rectangle strip)
+{
+    bool hasStrip = strip.width > 0 && strip.height > 0;
+    int count = def->frames;
+    if (count <= 0)
+        count = hasStrip ? (int)strip.width / (int)strip.height : 1;
+    if (count < 1 || !hasStrip)
+        count = 1;
+    if (count > ANIM_MAX_FRAMES)
+        count = ANIM_MAX_FRAMES;
+
+    clip->sprite = hasStrip ? def->sprite : -1;
+    clip->frameCount = count;
+    clip->mode = def->mode;
+    clip->duration = 0.0f;
+    bool timed = def->frameTimes && def->frames == count;
+    for (int f = 0; f < count; f++)
+    {
+        float w = strip.width / count;
+        clip->frames[f] = (Rectangle){f * w, 0, w, strip.height};
+        clip->frameTime[f] = timed ? def->frameTimes[f] : def->duration / count;
+        clip->duration += clip->frameTime[f];
+    }
+    if (!timed)
+        clip->duration = def->duration;
+    for (int t = 0; t < ANIM_TRACK_COUNT; t++)
+        clip->tracks[t] = def->tracks[t];
+}
+
+static inline void AnimPoolClear(AnimPool *pool, const AnimClip *clips)
+{
+    pool->clips = clips;
+    pool->count = 0;
+    pool->freeCount = 0;
+    pool->nextId = 0;
+}
+
+static inline int AnimSlot(const AnimPool *pool, int handle)
+{
+    if (handle < 0)
+        return ANIM_NONE;
+    int id = handle & 0xFFFF;
+    if (id >= pool->nextId || pool->generation[id] != (handle >> 16))
+        return ANIM_NONE;
+    return pool->slotOf[id];
+}
+
+static inline bool AnimIsPlaying(const AnimPool *pool, int handle)
+{
+    return AnimSlot(pool, handle) != ANIM_NONE;
+}
+
+static inline void AnimRemoveSlot(AnimPool *pool, int i)
+{
+    int id = pool->idOf[i];
+    int last = --pool->count;
+    if (i != last)
+    {
+        pool->clip[i] = pool->clip[last];
+        pool->left[i] = pool->left[last];
+        pool->frameTime[i] = pool->frameTime[last];
+        pool->frame[i] = pool->frame[last];
+        pool->idOf[i] = pool->idOf[last];
+        pool->slotOf[pool->idOf[i]] = i;
+    }
+    pool->slotOf[id] = ANIM_NONE;
+    pool->generation[id] = (pool->generation[id] + 1) & 0x7FFF;
+    pool->freeIds[pool->freeCount++] = id;
+}
+
+static inline void AnimStop(AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    if (i != ANIM_NONE)
+        AnimRemoveSlot(pool, i);
+}
+
+/* Starts clip from its first frame, reusing handle's instance when it is
+   still playing. Returns the handle to keep, or ANIM_NONE when full. */
+static inline int AnimPlay(AnimPool *pool, int handle, int clip)
+{
+    int i = AnimSlot(pool, handle);
+    if (i == ANIM_NONE)
+    {
+        if (pool->count >= ANIM_MAX_INSTANCES || (pool->freeCount == 0 && pool->nextId >= ANIM_MAX_INSTANCES))
+            return ANIM_NONE;
+        int id;
+        if (pool->freeCount > 0)
+        {
+            id = pool->freeIds[--pool->freeCount];
+        }
+        else
+        {
+            id = pool->nextId++;
+            pool->generation[id] = 0;
+        }
+        i = pool->count++;
+        pool->idOf[i] = id;
+        pool->slotOf[id] = i;
+        handle = (pool->generation[id] << 16) | id;
+    }
+    pool->clip[i] = clip;
+    pool->left[i] = pool->clips[clip].duration;
+    pool->frameTime[i] = 0.0f;
+    pool->frame[i] = 0;
+    return handle;
+}
+
+/* Puts an instance in an exact state (save files, spectators); a left of
+   zero or less stops it. */
+static inline int AnimSetState(AnimPool *pool, int handle, int clip, float left, int frame, float frameTime)
+{
+    if (left <= 0.0f || clip < 0)
+    {
+        AnimStop(pool, handle);
+        return ANIM_NONE;
+    }
+    handle = AnimPlay(pool, handle, clip);
+    int i = AnimSlot(pool, handle);
+    if (i == ANIM_NONE)
+        return ANIM_NONE;
+    int count = pool->clips[clip].frameCount;
+    pool->left[i] = left;
+    pool->frame[i] = frame >= 0 ? frame % count : 0;
+    pool->frameTime[i] = frameTime;
+    return handle;
+}
+
+/* Advances every instance by delta. The first loop has no data-dependent
+   branches so it vectorizes; frame changes and clip ends take the second. */
+static inline void AnimTick(AnimPool *pool, float delta)
+{
+    int n = pool->count;
+    for (int i = 0; i < n; i++)
+    {
+        pool->left[i] -= delta;
+        pool->frameTime[i] += delta;
+    }
+
+    for (int i = 0; i < pool->count;)
+    {
+        const AnimClip *c = &pool->clips[pool->clip[i]];
+        while (pool->frameTime[i] >= c->frameTime[pool->frame[i]])
+        {
+            int next = pool->frame[i] + 1;
+            if (next >= c->frameCount)
+            {
+                if (c->mode != ANIM_LOOP)
+                    break;
+                next = 0;
+            }
+            if (c->frameTime[pool->frame[i]] <= 0.0f)
+                break;
+            pool->frameTime[i] -= c->frameTime[pool->frame[i]];
+            pool->frame[i] = next;
+        }
+
+        if (pool->left[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+        if (c->mode == ANIM_LOOP && c->duration > 0.0f)
+        {
+            pool->left[i] += c->duration;
+            i++;
+            continue;
+        }
+        AnimRemoveSlot(pool, i);
+    }
+}
+
+static inline int AnimFrame(const AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    return i == ANIM_NONE ? 0 : pool->frame[i];
+}
+
+static inline float AnimTimeLeft(const AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    return i == ANIM_NONE ? 0.0f : pool->left[i];
+}
+
+static inline float AnimFrameTime(const AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    return i == ANIM_NONE ? 0.0f : pool->frameTime[i];
+}
+
+/* Sprite of the playing clip, or -1 when stopped or track-only. */
+static inline int AnimSprite(const AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    return i == ANIM_NONE ? -1 : pool->clips[pool->clip[i]].sprite;
+}
+
+static inline Rectangle AnimFrameRect(const AnimPool *pool, int handle)
+{
+    int i = AnimSlot(pool, handle);
+    if (i == ANIM_NONE)
+        return (Rectangle){0, 0, 0, 0};
+    const AnimClip *c = &pool->clips[pool->clip[i]];
+    return c->frames[pool->frame[i] < c->frameCount ? pool->frame[i] : 0];
+}
+
+/* Value of one track of the playing clip, or fallback when the handle is
+   stopped or the clip leaves that track alone. */
+static inline float AnimTrackValue(const AnimPool *pool, int handle, AnimTrack track, float fallback)
+{
+    int i = AnimSlot(pool, handle);
+    if (i == ANIM_NONE)
+        return fallback;
+    const AnimClip *c = &pool->clips[pool->clip[i]];
+    const AnimTrackDef *t = &c->tracks[track];
+    switch (t->curve)
+    {
+    case ANIM_CURVE_ARC:
+        return t->amount * sinf((1.0f - pool->left[i] / c->duration) * 3.14f);
+    case ANIM_CURVE_BLINK:
+        return ((int)(pool->left[i] * t->rate) % 2 == 0) ? t->amount : 1.0f;
+    default:
+        return fallback;
+    }
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "raylib.h"
+#include "pack.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#define ATLAS_PAGE_SIZE 2048
+#define ATLAS_MAX_PAGES 4
+#define ATLAS_PADDING 2
+
+typedef enum
+{
+    SPRITE_PLAYER,
+    SPRITE_BOSS,
+    SPRITE_PLAYER_ATTACK,
+    SPRITE_BOSS_ATTACK,
+    SPRITE_PLAYER_HIT,
+    SPRITE_BOSS_HIT,
+    SPRITE_COUNT
+} SpriteId;
+
+static const char *const spriteAssetNames[SPRITE_COUNT] = {
+    "boss_player/player",
+    "boss_player/boss",
+    "player_attack",
+    "boss_attack",
+    "player_hit",
+    "boss_hit",
+};
+
+typedef struct
+{
+    bool present;
+    int page;
+    Rectangle rect;
+} AtlasSprite;
+
+static Texture2D atlasPages[ATLAS_MAX_PAGES];
+static int atlasPageCount = 0;
+static AtlasSprite atlasSprites[SPRITE_COUNT];
+
+Image LoadAssetImage(const char *baseName);
+
+static bool AtlasHas(SpriteId id)
+{
+    return atlasSprites[id].present && atlasPages[atlasSprites[id].page].id != 0;
+}
+
+static Rectangle AtlasRect(SpriteId id)
+{
+    return atlasSprites[id].rect;
+}
+
+/* src is relative to the sprite's own rectangle, like a standalone texture. */
+static inline void AtlasDraw(SpriteId id, Rectangle src, Rectangle dest, Vector2 origin, float rotation, Color tint)
+{
+    const AtlasSprite *s = &atlasSprites[id];
+    src.x += s->rect.x;
+    src.y += s->rect.y;
+    DrawTexturePro(atlasPages[s->page], src, dest, origin, rotation, tint);
+}
+
+/* Shelf-packs every sprite image, tallest first, into as few pages as fit.
+   Takes ownership of the images; missing sprites have data == NULL. */
+static void AtlasBuildFromImages(Image images[SPRITE_COUNT])
+{
+    int order[SPRITE_COUNT];
+    int count = 0;
+
+    for (int i = 0; i < SPRITE_COUNT; i++)
+    {
+        atlasSprites[i].present = false;
+        if (images[i].data == NULL || images[i].width > ATLAS_PAGE_SIZE || images[i].height > ATLAS_PAGE_SIZE)
+            continue;
+        if (!PackOwns(images[i].data))
+            ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (images[i].format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+            continue;
+
+        int j = count++;
+        while (j > 0 && images[order[j - 1]].height < images[i].height)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    int page = 0, x = 0, y = 0, shelfHeight = 0;
+    int pageHeight[ATLAS_MAX_PAGES] = {0};
+    for (int k = 0; k < count; k++)
+    {
+        Image *img = &images[order[k]];
+        if (x + img->width > ATLAS_PAGE_SIZE)
+        {
+            x = 0;
+            y += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        if (y + img->height > ATLAS_PAGE_SIZE)
+        {
+            if (page + 1 >= ATLAS_MAX_PAGES)
+                break;
+            page++;
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+
+        AtlasSprite *s = &atlasSprites[order[k]];
+        s->present = true;
+        s->page = page;
+        s->rect = (Rectangle){(float)x, (float)y, (float)img->width, (float)img->height};
+
+        x += img->width + ATLAS_PADDING;
+        if (img->height > shelfHeight)
+            shelfHeight = img->height;
+        if (y + shelfHeight > pageHeight[page])
+            pageHeight[page] = y + shelfHeight;
+    }
+
+    atlasPageCount = (count > 0) ? page + 1 : 0;
+    for (int p = 0; p < atlasPageCount; p++)
+    {
+        Image canvas = GenImageColor(ATLAS_PAGE_SIZE, pageHeight[p], BLANK);
+        for (int i = 0; i < SPRITE_COUNT; i++)
+        {
+            if (!atlasSprites[i].present || atlasSprites[i].page != p)
+                continue;
+            Rectangle r = atlasSprites[i].rect;
+            ImageDraw(&canvas, images[i], (Rectangle){0, 0, r.width, r.height}, r, WHITE);
+        }
+        atlasPages[p] = LoadTextureFromImage(canvas);
+        UnloadImage(canvas);
+    }
+
+    for (int i = 0; i < SPRITE_COUNT; i++)
+    {
+        ReleaseAssetImage(images[i]);
+    }
+}
+
+static void AtlasUnload(void)
+{
+    for (int p = 0; p < atlasPageCount; p++)
+    {
+        if (atlasPages[p].id)
+            UnloadTexture(atlasPages[p]);
+        atlasPages[p] = (Texture2D){0};
+    }
+    atlasPageCount = 0;
+    for (int i = 0; i < SPRITE_COUNT; i++)
+        atlasSprites[i].present = false;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct
+{
+    long long wins;
+    long long losses;
+    long long escapes;
+    long long turns;
+    double seconds;
+} BatchResult;
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool RunBatch(const ItemType inventory[INVENTORY_SIZE], int lanes, long long battles, uint64_t seed,
+                     bool useAVX2, BatchResult *out)
+{
+    BattleBatch batch;
+    if (!BattleBatchInit(&batch, lanes, inventory, battles, seed))
+    {
+        BattleBatchFree(&batch);
+        return false;
+    }
+
+    double start = Now();
+    while (!BattleBatchDone(&batch))
+        BattleBatchStep(&batch, useAVX2);
+    out->seconds = Now() - start;
+
+    out->wins = batch.wins;
+    out->losses = batch.losses;
+    out->escapes = batch.escapes;
+    out->turns = batch.turnTotal;
+    BattleBatchFree(&batch);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    long long battles = (argc > 1) ? atoll(argv[1]) : 2000000;
+    int lanes = (argc > 2) ? atoi(argv[2]) : 4096;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+
+    if (battles < 1)
+        battles = 1;
+    if (lanes < BATCH_LANE_GROUP)
+        lanes = BATCH_LANE_GROUP;
+
+    bool hasAVX2 = BattleBatchHasAVX2();
+    ItemType builds[1 << STAGE_COUNT][INVENTORY_SIZE];
+    int buildCount = CombatEnumerateBuilds(builds, 1 << STAGE_COUNT);
+    bool allMatch = true;
+    double scalarTime = 0.0, simdTime = 0.0;
+
+    printf("%-36s %10s %10s %10s %8s  %s\n", "Build", "Vitoria", "Derrota", "Fuga", "Turnos", "AVX2 == escalar");
+    for (int b = 0; b < buildCount; b++)
+    {
+        BatchResult scalar, simd;
+        if (!RunBatch(builds[b], lanes, battles, seed, false, &scalar))
+        {
+            fprintf(stderr, "Sem memoria para %d lanes\n", lanes);
+            return 1;
+        }
+        scalarTime += scalar.seconds;
+
+        bool match = true;
+        if (hasAVX2)
+        {
+            RunBatch(builds[b], lanes, battles, seed, true, &simd);
+            simdTime += simd.seconds;
+            match = scalar.wins == simd.wins && scalar.losses == simd.losses &&
+                    scalar.escapes == simd.escapes && scalar.turns == simd.turns;
+            allMatch = allMatch && match;
+        }
+
+        char name[64] = "";
+        for (int s = 0; s < INVENTORY_SIZE; s++)
+        {
+            if (s > 0)
+                strcat(name, "+");
+            strcat(name, GetItemShortName(builds[b][s]));
+        }
+
+        double n = (double)battles;
+        printf("%-36s %9.3f%% %9.3f%% %9.3f%% %8.2f  %s\n", name, 100.0 * scalar.wins / n, 100.0 * scalar.losses / n,
+               100.0 * scalar.escapes / n, scalar.turns / n, hasAVX2 ? (match ? "sim" : "NAO") : "-");
+    }
+
+    double total = (double)battles * buildCount;
+    printf("\nEscalar: %.2f M batalhas/s\n", total / scalarTime / 1e6);
+    if (hasAVX2)
+        printf("AVX2:    %.2f M batalhas/s (%.2fx)\n", total / simdTime / 1e6, scalarTime / simdTime);
+    else
+        printf("AVX2:    indisponivel nesta CPU\n");
+
+    return allMatch ? 0 : 1;
+}
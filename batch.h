@@ -0,0 +1,388 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "combat.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#define BATCH_LANE_GROUP 4
+
+/* N battles of one build in structure-of-arrays form, all driven by the
+   heuristic policy in combat.h. Each lane owns a xoshiro256** stream stored
+   as four word arrays. Finished lanes are tallied and restarted while
+   battles remain pending; after that they are masked out. */
+typedef struct
+{
+    int lanes;
+    int32_t *playerHp;
+    int32_t *bossHp;
+    int32_t *armor;
+    int32_t *itemUsed;
+    int32_t *turns;
+    int32_t *active;
+    int32_t *outcome;
+    uint64_t *rng[4];
+    ItemType inventory[INVENTORY_SIZE];
+    bool hasSword;
+    long long pending;
+    long long running;
+    long long wins;
+    long long losses;
+    long long escapes;
+    long long turnTotal;
+} BattleBatch;
+
+static inline void *BatchAlloc(size_t size)
+{
+    void *p = NULL;
+    if (posix_memalign(&p, 32, size) != 0)
+        return NULL;
+    memset(p, 0, size);
+    return p;
+}
+
+static inline void BattleBatchResetLane(BattleBatch *batch, int i)
+{
+    batch->playerHp[i] = PLAYER_START_HP;
+    batch->bossHp[i] = BOSS_START_HP;
+    batch->armor[i] = 0;
+    batch->itemUsed[i] = 0;
+    batch->turns[i] = 0;
+    batch->outcome[i] = BATTLE_ONGOING;
+}
+
+static inline void BattleBatchStartLane(BattleBatch *batch, int i)
+{
+    if (batch->pending > 0)
+    {
+        batch->pending--;
+        batch->running++;
+        batch->active[i] = 1;
+        BattleBatchResetLane(batch, i);
+    }
+    else
+    {
+        batch->active[i] = 0;
+    }
+}
+
+static inline bool BattleBatchInit(BattleBatch *batch, int lanes, const ItemType inventory[INVENTORY_SIZE],
+                                   long long battles, uint64_t seed)
+{
+    memset(batch, 0, sizeof(*batch));
+    lanes = (lanes + BATCH_LANE_GROUP - 1) / BATCH_LANE_GROUP * BATCH_LANE_GROUP;
+    batch->lanes = lanes;
+
+    size_t words = sizeof(int32_t) * (size_t)lanes;
+    batch->playerHp = BatchAlloc(words);
+    batch->bossHp = BatchAlloc(words);
+    batch->armor = BatchAlloc(words);
+    batch->itemUsed = BatchAlloc(words);
+    batch->turns = BatchAlloc(words);
+    batch->active = BatchAlloc(words);
+    batch->outcome = BatchAlloc(words);
+    for (int k = 0; k < 4; k++)
+        batch->rng[k] = BatchAlloc(sizeof(uint64_t) * (size_t)lanes);
+
+    if (!batch->playerHp || !batch->bossHp || !batch->armor || !batch->itemUsed || !batch->turns ||
+        !batch->active || !batch->outcome || !batch->rng[0] || !batch->rng[1] || !batch->rng[2] || !batch->rng[3])
+        return false;
+
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        batch->inventory[i] = inventory[i];
+        batch->hasSword = batch->hasSword || inventory[i] == ITEM_SWORD;
+    }
+
+    Rng rng;
+    RngSeed(&rng, seed);
+    batch->pending = battles;
+    for (int i = 0; i < lanes; i++)
+    {
+        for (int k = 0; k < 4; k++)
+            batch->rng[k][i] = rng.s[k];
+        RngJump(&rng);
+        BattleBatchStartLane(batch, i);
+    }
+    return true;
+}
+
+static inline void BattleBatchFree(BattleBatch *batch)
+{
+    free(batch->playerHp);
+    free(batch->bossHp);
+    free(batch->armor);
+    free(batch->itemUsed);
+    free(batch->turns);
+    free(batch->active);
+    free(batch->outcome);
+    for (int k = 0; k < 4; k++)
+        free(batch->rng[k]);
+    memset(batch, 0, sizeof(*batch));
+}
+
+static inline void BattleBatchFinishLane(BattleBatch *batch, int i)
+{
+    switch (batch->outcome[i])
+    {
+    case BATTLE_WON:
+        batch->wins++;
+        break;
+    case BATTLE_ESCAPED:
+        batch->escapes++;
+        break;
+    default:
+        batch->losses++;
+        break;
+    }
+    batch->turnTotal += batch->turns[i];
+    batch->running--;
+    BattleBatchStartLane(batch, i);
+}
+
+static inline void BattleBatchStepScalar(BattleBatch *batch)
+{
+    for (int i = 0; i < batch->lanes; i++)
+    {
+        if (!batch->active[i])
+            continue;
+
+        Battle b;
+        BattleInit(&b, batch->inventory);
+        b.playerHp = batch->playerHp[i];
+        b.bossHp = batch->bossHp[i];
+        b.playerHasArmor = batch->armor[i] != 0;
+        b.itemUsed = (unsigned char)batch->itemUsed[i];
+        b.turns = batch->turns[i];
+
+        Rng rng;
+        for (int k = 0; k < 4; k++)
+            rng.s[k] = batch->rng[k][i];
+
+        if (!BattlePlayerAct(&b, CombatHeuristicAction(&b), &rng))
+            BattlePlayerAct(&b, ACTION_ATTACK, &rng);
+        if (b.outcome == BATTLE_ONGOING)
+            BattleBossAct(&b, &rng);
+
+        batch->playerHp[i] = b.playerHp;
+        batch->bossHp[i] = b.bossHp;
+        batch->armor[i] = b.playerHasArmor ? 1 : 0;
+        batch->itemUsed[i] = b.itemUsed;
+        batch->turns[i] = b.turns;
+        batch->outcome[i] = b.outcome;
+        for (int k = 0; k < 4; k++)
+            batch->rng[k][i] = rng.s[k];
+
+        if (b.outcome != BATTLE_ONGOING)
+            BattleBatchFinishLane(batch, i);
+    }
+}
+
+#ifdef BATCH_HAVE_AVX2
+
+#define BATCH_AVX2 __attribute__((target("avx2")))
+
+BATCH_AVX2 static inline __m256i BatchLoad32(const int32_t *p)
+{
+    return _mm256_cvtepi32_epi64(_mm_load_si128((const __m128i *)p));
+}
+
+BATCH_AVX2 static inline void BatchStore32(int32_t *p, __m256i v)
+{
+    __m256i packed = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0));
+    _mm_store_si128((__m128i *)p, _mm256_castsi256_si128(packed));
+}
+
+BATCH_AVX2 static inline __m256i BatchRotl(__m256i x, int k)
+{
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+/* One xoshiro256** step on the lanes selected by mask; other lanes keep their
+   state so they stay in sync with the scalar path. */
+BATCH_AVX2 static inline __m256i BatchRngNext(__m256i s[4], __m256i mask)
+{
+    __m256i x5 = _mm256_add_epi64(_mm256_slli_epi64(s[1], 2), s[1]);
+    __m256i r = BatchRotl(x5, 7);
+    __m256i result = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+    __m256i t = _mm256_slli_epi64(s[1], 17);
+
+    __m256i n2 = _mm256_xor_si256(s[2], s[0]);
+    __m256i n3 = _mm256_xor_si256(s[3], s[1]);
+    __m256i n1 = _mm256_xor_si256(s[1], n2);
+    __m256i n0 = _mm256_xor_si256(s[0], n3);
+    n2 = _mm256_xor_si256(n2, t);
+    n3 = BatchRotl(n3, 45);
+
+    s[0] = _mm256_blendv_epi8(s[0], n0, mask);
+    s[1] = _mm256_blendv_epi8(s[1], n1, mask);
+    s[2] = _mm256_blendv_epi8(s[2], n2, mask);
+    s[3] = _mm256_blendv_epi8(s[3], n3, mask);
+    return result;
+}
+
+BATCH_AVX2 static inline __m256i BatchRange(__m256i r, __m256i min, __m256i n)
+{
+    __m256i hi = _mm256_srli_epi64(r, 32);
+    return _mm256_add_epi64(min, _mm256_srli_epi64(_mm256_mul_epu32(hi, n), 32));
+}
+
+BATCH_AVX2 static inline __m256i BatchSelect(__m256i a, __m256i b, __m256i mask)
+{
+    return _mm256_blendv_epi8(a, b, mask);
+}
+
+BATCH_AVX2 static void BattleBatchStepAVX2(BattleBatch *batch)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i none = _mm256_set1_epi64x(-1);
+
+    int atkMin, atkMax, plainMin, plainMax, armoredMin, armoredMax;
+    CombatPlayerDamageRange(batch->hasSword, &atkMin, &atkMax);
+    CombatBossDamageRange(BOSS_START_ATTACK, false, &plainMin, &plainMax);
+    CombatBossDamageRange(BOSS_START_ATTACK, true, &armoredMin, &armoredMax);
+
+    int armorSlot = -1;
+    for (int s = 0; s < INVENTORY_SIZE && armorSlot < 0; s++)
+    {
+        if (batch->inventory[s] == ITEM_ARMOR)
+            armorSlot = s;
+    }
+    const __m256i armorSlotV = _mm256_set1_epi64x(armorSlot);
+
+    for (int i = 0; i < batch->lanes; i += BATCH_LANE_GROUP)
+    {
+        __m256i act = _mm256_cmpgt_epi64(BatchLoad32(batch->active + i), zero);
+        if (_mm256_testz_si256(act, act))
+            continue;
+
+        __m256i p = BatchLoad32(batch->playerHp + i);
+        __m256i b = BatchLoad32(batch->bossHp + i);
+        __m256i ar = _mm256_cmpgt_epi64(BatchLoad32(batch->armor + i), zero);
+        __m256i used = BatchLoad32(batch->itemUsed + i);
+        __m256i turns = BatchLoad32(batch->turns + i);
+        __m256i s[4];
+        for (int k = 0; k < 4; k++)
+            s[k] = _mm256_load_si256((const __m256i *)(batch->rng[k] + i));
+
+        __m256i potionSlot = none, bombSlot = none, coinSlot = none;
+        for (int slot = INVENTORY_SIZE - 1; slot >= 0; slot--)
+        {
+            __m256i unused = _mm256_cmpeq_epi64(_mm256_and_si256(used, _mm256_set1_epi64x(1ll << slot)), zero);
+            __m256i slotV = _mm256_set1_epi64x(slot);
+            if (batch->inventory[slot] == ITEM_POTION)
+                potionSlot = BatchSelect(potionSlot, slotV, unused);
+            else if (batch->inventory[slot] == ITEM_BOMB)
+                bombSlot = BatchSelect(bombSlot, slotV, unused);
+            else if (batch->inventory[slot] == ITEM_COIN)
+                coinSlot = BatchSelect(coinSlot, slotV, unused);
+        }
+
+        __m256i bossMax = BatchSelect(_mm256_set1_epi64x(plainMax), _mm256_set1_epi64x(armoredMax), ar);
+        __m256i low = _mm256_cmpgt_epi64(_mm256_add_epi64(bossMax, one), p);
+
+        __m256i doArmor = _mm256_andnot_si256(ar, _mm256_cmpgt_epi64(armorSlotV, none));
+        doArmor = _mm256_and_si256(doArmor, act);
+        __m256i rest = _mm256_andnot_si256(doArmor, act);
+        __m256i doBomb = _mm256_and_si256(rest, _mm256_cmpgt_epi64(bombSlot, none));
+        rest = _mm256_andnot_si256(doBomb, rest);
+        __m256i doPotion = _mm256_and_si256(_mm256_and_si256(rest, low), _mm256_cmpgt_epi64(potionSlot, none));
+        rest = _mm256_andnot_si256(doPotion, rest);
+        __m256i doCoin = _mm256_and_si256(_mm256_and_si256(rest, low), _mm256_cmpgt_epi64(coinSlot, none));
+        __m256i doAttack = _mm256_andnot_si256(doCoin, rest);
+
+        __m256i hits = _mm256_or_si256(doAttack, doBomb);
+        __m256i roll = BatchRngNext(s, _mm256_or_si256(hits, doCoin));
+        __m256i dmgMin = BatchSelect(_mm256_set1_epi64x(atkMin), _mm256_set1_epi64x(BOMB_MIN_DAMAGE), doBomb);
+        __m256i dmgN = BatchSelect(_mm256_set1_epi64x(atkMax - atkMin + 1),
+                                   _mm256_set1_epi64x(BOMB_MAX_DAMAGE - BOMB_MIN_DAMAGE + 1), doBomb);
+        __m256i dmg = BatchRange(roll, dmgMin, dmgN);
+        b = BatchSelect(b, _mm256_sub_epi64(b, dmg), hits);
+        b = BatchSelect(b, zero, _mm256_cmpgt_epi64(zero, b));
+
+        __m256i escaped = _mm256_and_si256(doCoin, _mm256_cmpeq_epi64(_mm256_and_si256(roll, one), zero));
+
+        __m256i healed = _mm256_add_epi64(p, _mm256_set1_epi64x(POTION_HEAL));
+        __m256i maxHp = _mm256_set1_epi64x(PLAYER_START_HP);
+        healed = BatchSelect(healed, maxHp, _mm256_cmpgt_epi64(healed, maxHp));
+        p = BatchSelect(p, healed, doPotion);
+        ar = _mm256_or_si256(ar, doArmor);
+
+        __m256i spentSlot = BatchSelect(BatchSelect(potionSlot, bombSlot, doBomb), coinSlot, doCoin);
+        __m256i spends = _mm256_or_si256(_mm256_or_si256(doPotion, doBomb), doCoin);
+        used = _mm256_or_si256(used, _mm256_and_si256(_mm256_sllv_epi64(one, spentSlot), spends));
+        turns = _mm256_sub_epi64(turns, act);
+
+        __m256i won = _mm256_and_si256(act, _mm256_cmpeq_epi64(b, zero));
+        __m256i bossTurn = _mm256_andnot_si256(_mm256_or_si256(won, escaped), act);
+
+        __m256i bossRoll = BatchRngNext(s, bossTurn);
+        __m256i bossMin = BatchSelect(_mm256_set1_epi64x(plainMin), _mm256_set1_epi64x(armoredMin), ar);
+        __m256i bossN = BatchSelect(_mm256_set1_epi64x(plainMax - plainMin + 1),
+                                    _mm256_set1_epi64x(armoredMax - armoredMin + 1), ar);
+        p = BatchSelect(p, _mm256_sub_epi64(p, BatchRange(bossRoll, bossMin, bossN)), bossTurn);
+        p = BatchSelect(p, zero, _mm256_cmpgt_epi64(zero, p));
+        __m256i lost = _mm256_and_si256(bossTurn, _mm256_cmpeq_epi64(p, zero));
+
+        __m256i outcome = _mm256_and_si256(won, _mm256_set1_epi64x(BATTLE_WON));
+        outcome = BatchSelect(outcome, _mm256_set1_epi64x(BATTLE_LOST), lost);
+        outcome = BatchSelect(outcome, _mm256_set1_epi64x(BATTLE_ESCAPED), escaped);
+
+        BatchStore32(batch->playerHp + i, p);
+        BatchStore32(batch->bossHp + i, b);
+        BatchStore32(batch->armor + i, _mm256_and_si256(ar, one));
+        BatchStore32(batch->itemUsed + i, used);
+        BatchStore32(batch->turns + i, turns);
+        BatchStore32(batch->outcome + i, outcome);
+        for (int k = 0; k < 4; k++)
+            _mm256_store_si256((__m256i *)(batch->rng[k] + i), s[k]);
+
+        int finished = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_or_si256(won, lost), escaped)));
+        for (int lane = 0; lane < BATCH_LANE_GROUP; lane++)
+        {
+            if (finished & (1 << lane))
+                BattleBatchFinishLane(batch, i + lane);
+        }
+    }
+}
+
+static inline bool BattleBatchHasAVX2(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+static inline bool BattleBatchHasAVX2(void)
+{
+    return false;
+}
+
+#endif
+
+static inline void BattleBatchStep(BattleBatch *batch, bool useAVX2)
+{
+#ifdef BATCH_HAVE_AVX2
+    if (useAVX2)
+    {
+        BattleBatchStepAVX2(batch);
+        return;
+    }
+#else
+    (void)useAVX2;
+#endif
+    BattleBatchStepScalar(batch);
+}
+
+static inline bool BattleBatchDone(const BattleBatch *batch)
+{
+    return batch->pending == 0 && batch->running == 0;
+}
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef BATTLELOG_H
+#define BATTLELOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define BATTLE_LOG_CAPACITY 256
+#define BATTLE_LOG_MASK (BATTLE_LOG_CAPACITY - 1)
+#define BATTLE_LOG_LINE_SIZE 128
+#define BATTLE_LOG_DEFAULT_PATH "rush_rpg_batalha.txt"
+
+typedef enum
+{
+    BATTLE_LOG_SYSTEM,
+    BATTLE_LOG_PLAYER,
+    BATTLE_LOG_BOSS
+} BattleLogActor;
+
+typedef enum
+{
+    BATTLE_LOG_START,
+    BATTLE_LOG_ATTACK_SWORD,
+    BATTLE_LOG_ATTACK_UNARMED,
+    BATTLE_LOG_BOSS_ATTACK,
+    BATTLE_LOG_BOSS_ATTACK_ARMOR,
+    BATTLE_LOG_POTION,
+    BATTLE_LOG_BOMB,
+    BATTLE_LOG_COIN_ESCAPE,
+    BATTLE_LOG_COIN_FAIL,
+    BATTLE_LOG_ARMOR,
+    BATTLE_LOG_SWORD_HINT,
+    BATTLE_LOG_ITEM_SPENT,
+    BATTLE_LOG_ITEM_INVALID,
+    BATTLE_LOG_VICTORY,
+    BATTLE_LOG_DEFEAT
+} BattleLogAction;
+
+/* One line of the log, kept as data; the text is only built when the line
+   is shown or exported. 8 bytes, so it goes into saves and spectator
+   records as-is. */
+typedef struct
+{
+    uint16_t turn;
+    uint8_t actor;
+    uint8_t action;
+    int32_t amount;
+} BattleLogEntry;
+
+/* Ring of the last BATTLE_LOG_CAPACITY entries. Entry number n (counting
+   every push since the log was cleared) lives in entries[n & BATTLE_LOG_MASK],
+   so a push overwrites the oldest line and never allocates. */
+typedef struct
+{
+    BattleLogEntry entries[BATTLE_LOG_CAPACITY];
+    uint32_t total;
+    int turn;
+} BattleLog;
+
+static inline void BattleLogClear(BattleLog *log)
+{
+    memset(log, 0, sizeof(*log));
+    log->turn = 1;
+}
+
+static inline int BattleLogCount(const BattleLog *log)
+{
+    return log->total < BATTLE_LOG_CAPACITY ? (int)log->total : BATTLE_LOG_CAPACITY;
+}
+
+/* age 0 is the newest entry; NULL past the oldest one still kept. */
+static inline const BattleLogEntry *BattleLogRecent(const BattleLog *log, int age)
+{
+    if (age < 0 || age >= BattleLogCount(log))
+        return NULL;
+    return &log->entries[(log->total - 1 - (uint32_t)age) & BATTLE_LOG_MASK];
+}
+
+/* Adds an entry for the current turn. Repeating the newest entry (a hint
+   for the same key pressed twice in one turn) adds nothing. */
+static inline void BattleLogPush(BattleLog *log, BattleLogActor actor, BattleLogAction action, int amount)
+{
+    BattleLogEntry entry = {(uint16_t)log->turn, (uint8_t)actor, (uint8_t)action, amount};
+    const BattleLogEntry *last = BattleLogRecent(log, 0);
+    if (last && memcmp(last, &entry, sizeof(entry)) == 0)
+        return;
+    log->entries[log->total & BATTLE_LOG_MASK] = entry;
+    log->total++;
+}
+
+/* Copies the newest entries into ring, a power-of-two array indexed the same
+   way as the log, so an unchanged entry stays in the same place from one
+   copy to the next. */
+static inline void BattleLogSnapshot(const BattleLog *log, BattleLogEntry *ring, int ringSize)
+{
+    int count = BattleLogCount(log) < ringSize ? BattleLogCount(log) : ringSize;
+    memset(ring, 0, sizeof(BattleLogEntry) * (size_t)ringSize);
+    for (uint32_t n = log->total - (uint32_t)count; n != log->total; n++)
+        ring[n & (uint32_t)(ringSize - 1)] = log->entries[n & BATTLE_LOG_MASK];
+}
+
+static inline void BattleLogRestore(BattleLog *log, uint32_t total, int turn, const BattleLogEntry *ring, int ringSize)
+{
+    BattleLogClear(log);
+    log->total = total;
+    log->turn = turn;
+    int count = BattleLogCount(log) < ringSize ? BattleLogCount(log) : ringSize;
+    for (uint32_t n = total - (uint32_t)count; n != total; n++)
+        log->entries[n & BATTLE_LOG_MASK] = ring[n & (uint32_t)(ringSize - 1)];
+}
+
+static inline const char *BattleLogActorName(uint8_t actor)
+{
+    switch (actor)
+    {
+    case BATTLE_LOG_PLAYER:
+        return "Voce";
+    case BATTLE_LOG_BOSS:
+        return "Chefe";
+    default:
+        return "-";
+    }
+}
+
+/* Writes the entry's sentence into out (at most size bytes) and returns out. */
+static inline const char *BattleLogFormat(const BattleLogEntry *entry, char *out, int size)
+{
+    int amount = entry->amount;
+    switch (entry->action)
+    {
+    case BATTLE_LOG_START:
+        if (amount > 0)
+            snprintf(out, (size_t)size, "Andar %d: batalha contra o Chefe! Escolha seu item.", amount);
+        else
+            snprintf(out, (size_t)size, "Batalha contra o Chefe! Escolha seu item.");
+        break;
+    case BATTLE_LOG_ATTACK_SWORD:
+        snprintf(out, (size_t)size, "Voce atacou com a espada! Causou %d de dano!", amount);
+        break;
+    case BATTLE_LOG_ATTACK_UNARMED:
+        snprintf(out, (size_t)size, "Voce atacou desarmado! Causou %d de dano!", amount);
+        break;
+    case BATTLE_LOG_BOSS_ATTACK:
+        snprintf(out, (size_t)size, "Chefe ataca! Voce levou %d de dano!", amount);
+        break;
+    case BATTLE_LOG_BOSS_ATTACK_ARMOR:
+        snprintf(out, (size_t)size, "Chefe ataca com armadura ativa! Voce levou %d de dano.", amount);
+        break;
+    case BATTLE_LOG_POTION:
+        snprintf(out, (size_t)size, "Voce usou Pocao! Curou %d HP!", amount);
+        break;
+    case BATTLE_LOG_BOMB:
+        snprintf(out, (size_t)size, "Voce usou Bomba! Causou %d de dano!", amount);
+        break;
+    case BATTLE_LOG_COIN_ESCAPE:
+        snprintf(out, (size_t)size, "Voce usou Moeda! Distraiu o chefe e fugiu!");
+        break;
+    case BATTLE_LOG_COIN_FAIL:
+        snprintf(out, (size_t)size, "Voce usou Moeda! Mas o chefe nao se distraiu...");
+        break;
+    case BATTLE_LOG_ARMOR:
+        snprintf(out, (size_t)size, "Voce equipou Armadura! Proximos ataques causarao menos dano.");
+        break;
+    case BATTLE_LOG_SWORD_HINT:
+        snprintf(out, (size_t)size, "Espada: aumenta seu dano. Use ATACAR [A].");
+        break;
+    case BATTLE_LOG_ITEM_SPENT:
+        snprintf(out, (size_t)size, "Este item ja foi usado!");
+        break;
+    case BATTLE_LOG_VICTORY:
+        snprintf(out, (size_t)size, "O chefe foi derrotado!");
+        break;
+    case BATTLE_LOG_DEFEAT:
+        snprintf(out, (size_t)size, "Voce foi derrotado.");
+        break;
+    case BATTLE_LOG_ITEM_INVALID:
+    default:
+        snprintf(out, (size_t)size, "Item invalido?");
+        break;
+    }
+    return out;
+}
+
+/* Plain text, oldest entry first, one "turn  actor  sentence" line each. */
+static inline bool BattleLogExport(const BattleLog *log, const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return false;
+
+    int count = BattleLogCount(log);
+    fprintf(f, "Registro de batalha: %d entradas", count);
+    if (log->total > (uint32_t)count)
+        fprintf(f, " (as %u mais antigas foram descartadas)", log->total - (uint32_t)count);
+    fprintf(f, "\n\n");
+
+    char line[BATTLE_LOG_LINE_SIZE];
+    for (int age = count - 1; age >= 0; age--)
+    {
+        const BattleLogEntry *entry = BattleLogRecent(log, age);
+        fprintf(f, "Turno %3d  %-5s  %s\n", entry->turn, BattleLogActorName(entry->actor), BattleLogFormat(entry, line, sizeof(line)));
+    }
+    return fclose(f) == 0;
+}
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define BENCH_MAX_FRAMES 65536
+#define BENCH_MAX_SCENARIOS 16
+#define BENCH_DEFAULT_BASELINE "bench_baseline.txt"
+#define BENCH_DEFAULT_THRESHOLD 0.20
+
+/* Differences below these are timer and allocator noise, never regressions. */
+#define BENCH_NOISE_FRAME_MS 0.05
+#define BENCH_NOISE_CPU_MS 5.0
+#define BENCH_NOISE_PEAK_KB 1024.0
+
+/* One line per scenario in the baseline file:
+   name frames p50_ms p95_ms p99_ms max_ms cpu_ms peak_kb
+   peak_kb is how far the resident set rose above where it stood when the
+   scenario started, so memory an earlier scenario left behind is not
+   counted again. */
+typedef struct
+{
+    char name[32];
+    int frames;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    double cpuMs;
+    long peakKb;
+} BenchResult;
+
+static float benchSamples[BENCH_MAX_FRAMES];
+static int benchSampleCount;
+static double benchCpuStart;
+static long benchPeakStart;
+
+static double BenchClockMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static double BenchCpuMs(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+}
+
+/* Peak resident set since the last BenchResetPeak (VmHWM), or -1 without
+   /proc. */
+static long BenchPeakKb(void)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+        return -1;
+    char line[256];
+    long kb = -1;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (strncmp(line, "VmHWM:", 6) == 0)
+            kb = atol(line + 6);
+    }
+    fclose(f);
+    return kb;
+}
+
+/* Lowers VmHWM to the current resident set, so the next BenchPeakKb covers
+   only what ran in between. */
+static bool BenchResetPeak(void)
+{
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (!f)
+        return false;
+    bool ok = fputs("5", f) >= 0;
+    return (fclose(f) == 0) && ok;
+}
+
+static long BenchProcessPeakKb(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+static void BenchStart(void)
+{
+    benchSampleCount = 0;
+    benchPeakStart = BenchResetPeak() ? BenchPeakKb() : -1;
+    benchCpuStart = BenchCpuMs();
+}
+
+static void BenchRecord(double frameMs)
+{
+    if (benchSampleCount < BENCH_MAX_FRAMES)
+        benchSamples[benchSampleCount++] = (float)frameMs;
+}
+
+static int BenchCompareFloat(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static double BenchPercentile(const float *sorted, int n, int pct)
+{
+    int i = (n * pct) / 100;
+    return sorted[i < n ? i : n - 1];
+}
+
+static BenchResult BenchFinish(const char *name)
+{
+    BenchResult r;
+    memset(&r, 0, sizeof(r));
+    snprintf(r.name, sizeof(r.name), "%s", name);
+    r.cpuMs = BenchCpuMs() - benchCpuStart;
+    long peak = benchPeakStart >= 0 ? BenchPeakKb() : -1;
+    r.peakKb = peak >= 0 ? peak - benchPeakStart : -1;
+    r.frames = benchSampleCount;
+    if (r.frames == 0)
+        return r;
+
+    qsort(benchSamples, (size_t)r.frames, sizeof(float), BenchCompareFloat);
+    r.p50 = BenchPercentile(benchSamples, r.frames, 50);
+    r.p95 = BenchPercentile(benchSamples, r.frames, 95);
+    r.p99 = BenchPercentile(benchSamples, r.frames, 99);
+    r.max = benchSamples[r.frames - 1];
+    return r;
+}
+
+static int BenchLoadBaseline(const char *path, BenchResult *out, int max)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    int count = 0;
+    while (count < max && fscanf(f, "%31s %d %lf %lf %lf %lf %lf %ld", out[count].name, &out[count].frames, &out[count].p50,
+                                 &out[count].p95, &out[count].p99, &out[count].max, &out[count].cpuMs, &out[count].peakKb) == 8)
+        count++;
+    fclose(f);
+    return count;
+}
+
+static bool BenchSaveBaseline(const char *path, const BenchResult *results, int count)
+{
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *f = fopen(tmpPath, "w");
+    if (!f)
+        return false;
+    for (int i = 0; i < count; i++)
+    {
+        const BenchResult *r = &results[i];
+        fprintf(f, "%s %d %.4f %.4f %.4f %.4f %.1f %ld\n", r->name, r->frames, r->p50, r->p95, r->p99, r->max, r->cpuMs, r->peakKb);
+    }
+    bool ok = ferror(f) == 0;
+    ok = (fclose(f) == 0) && ok;
+    return ok && rename(tmpPath, path) == 0;
+}
+
+static bool BenchRegressed(double current, double baseline, double threshold, double noise)
+{
+    return current > baseline * (1.0 + threshold) && current - baseline > noise;
+}
+
+/* Prints one row per scenario and returns how many regressed past threshold
+   on p50, p99, CPU time or peak memory. A peak of -1 (the scenario's own
+   peak could not be isolated) is shown as "-" and never compared; the
+   process-wide peak is printed once instead. */
+static int BenchReport(const BenchResult *results, int count, const BenchResult *baseline, int baselineCount, double threshold)
+{
+    int regressions = 0;
+    bool peakMissing = false;
+    printf("%-16s %7s %8s %8s %8s %8s %9s %9s\n", "cenario", "frames", "p50 ms", "p95 ms", "p99 ms", "max ms", "cpu ms", "+pico KB");
+    for (int i = 0; i < count; i++)
+    {
+        const BenchResult *r = &results[i];
+        printf("%-16s %7d %8.3f %8.3f %8.3f %8.3f %9.1f", r->name, r->frames, r->p50, r->p95, r->p99, r->max, r->cpuMs);
+        if (r->peakKb >= 0)
+            printf(" %9ld", r->peakKb);
+        else
+            printf(" %9s", "-");
+        peakMissing = peakMissing || r->peakKb < 0;
+
+        const BenchResult *b = NULL;
+        for (int j = 0; j < baselineCount && !b; j++)
+        {
+            if (strcmp(baseline[j].name, r->name) == 0)
+                b = &baseline[j];
+        }
+        if (!b)
+        {
+            printf("  (sem referencia)\n");
+            continue;
+        }
+
+        bool slow = BenchRegressed(r->p50, b->p50, threshold, BENCH_NOISE_FRAME_MS) ||
+                    BenchRegressed(r->p99, b->p99, threshold, BENCH_NOISE_FRAME_MS) ||
+                    BenchRegressed(r->cpuMs, b->cpuMs, threshold, BENCH_NOISE_CPU_MS) ||
+                    (r->peakKb >= 0 && b->peakKb >= 0 &&
+                     BenchRegressed((double)r->peakKb, (double)b->peakKb, threshold, BENCH_NOISE_PEAK_KB));
+        if (slow)
+        {
+            printf("  REGRESSAO (ref p50 %.3f p99 %.3f cpu %.1f pico %ld)\n", b->p50, b->p99, b->cpuMs, b->peakKb);
+            regressions++;
+        }
+        else
+        {
+            printf("  ok\n");
+        }
+    }
+    if (peakMissing)
+        printf("Pico de memoria do processo: %ld KB\n", BenchProcessPeakKb());
+    return regressions;
+}
+
+#endif
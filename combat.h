@@ -0,0 +1,416 @@
+#ifndef COMBAT_H
+#define COMBAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define INVENTORY_SIZE 4
+
+#define PLAYER_START_HP 120
+#define BOSS_START_HP 200
+#define BOSS_START_ATTACK 22
+#define POTION_HEAL 50
+#define BOMB_MIN_DAMAGE 60
+#define BOMB_MAX_DAMAGE 90
+#define SWORD_MIN_DAMAGE 20
+#define SWORD_MAX_DAMAGE 40
+#define UNARMED_MIN_DAMAGE 15
+#define UNARMED_MAX_DAMAGE 22
+#define STAGE_COUNT 4
+#define BOSS_ATTACK_SPREAD 5
+#define ARMOR_DIVISOR 2
+#define COIN_ESCAPE_PERCENT 50
+
+typedef enum
+{
+    ITEM_NONE,
+    ITEM_POTION,
+    ITEM_SWORD,
+    ITEM_BOMB,
+    ITEM_COIN,
+    ITEM_ARMOR
+} ItemType;
+
+typedef struct
+{
+    uint64_t s[4];
+} Rng;
+
+/* Every tunable number of the battle. The game and the tools use
+   combatDefaults; the sweep tool builds its own to try other balances. */
+typedef struct
+{
+    int playerHp;
+    int bossHp;
+    int bossAttack;
+    int bossSpread;
+    int armorDivisor;
+    int potionHeal;
+    int bombMin;
+    int bombMax;
+    int swordMin;
+    int swordMax;
+    int unarmedMin;
+    int unarmedMax;
+    int coinEscapePercent;
+} CombatParams;
+
+static const CombatParams combatDefaults = {
+    PLAYER_START_HP, BOSS_START_HP, BOSS_START_ATTACK, BOSS_ATTACK_SPREAD, ARMOR_DIVISOR, POTION_HEAL, BOMB_MIN_DAMAGE,
+    BOMB_MAX_DAMAGE, SWORD_MIN_DAMAGE, SWORD_MAX_DAMAGE, UNARMED_MIN_DAMAGE, UNARMED_MAX_DAMAGE, COIN_ESCAPE_PERCENT,
+};
+
+static inline uint64_t RngSplitMix(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline void RngSeed(Rng *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = RngSplitMix(&seed);
+}
+
+static inline uint64_t RngRotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/* xoshiro256** */
+static inline uint64_t RngNext(Rng *rng)
+{
+    uint64_t *s = rng->s;
+    uint64_t result = RngRotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RngRotl(s[3], 45);
+
+    return result;
+}
+
+/* Advances 2^128 steps, so streams split off one seed never overlap. */
+static inline void RngJump(Rng *rng)
+{
+    static const uint64_t JUMP[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                    0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (JUMP[i] & (1ull << b))
+            {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            RngNext(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+/* Multiply-high range reduction on the top 32 bits; the batch kernel
+   reproduces it lane by lane with a 32x32->64 multiply. */
+static inline int RngRange(Rng *rng, int min, int max)
+{
+    uint64_t hi = RngNext(rng) >> 32;
+    return min + (int)((hi * (uint64_t)(max - min + 1)) >> 32);
+}
+
+static inline ItemType GetItemForChoice(int stage, int choice)
+{
+    if (stage == 0)
+        return ITEM_POTION;
+    if (stage == 1)
+        return (choice == 0) ? ITEM_SWORD : ITEM_BOMB;
+    if (stage == 2)
+        return (choice == 0) ? ITEM_ARMOR : ITEM_COIN;
+    return ITEM_POTION;
+}
+
+static inline const char *GetItemShortName(ItemType item)
+{
+    switch (item)
+    {
+    case ITEM_POTION:
+        return "Pocao";
+    case ITEM_SWORD:
+        return "Espada";
+    case ITEM_BOMB:
+        return "Bomba";
+    case ITEM_COIN:
+        return "Moeda";
+    case ITEM_ARMOR:
+        return "Armadura";
+    default:
+        return "Vazio";
+    }
+}
+
+/* Distinct inventories reachable through the exploration doors. */
+static inline int CombatEnumerateBuilds(ItemType builds[][INVENTORY_SIZE], int maxBuilds)
+{
+    int count = 0;
+    for (int path = 0; path < (1 << STAGE_COUNT) && count < maxBuilds; path++)
+    {
+        ItemType inv[INVENTORY_SIZE] = {ITEM_NONE};
+        for (int stage = 0; stage < STAGE_COUNT && stage < INVENTORY_SIZE; stage++)
+            inv[stage] = GetItemForChoice(stage, (path >> stage) & 1);
+
+        bool seen = false;
+        for (int i = 0; i < count && !seen; i++)
+            seen = memcmp(builds[i], inv, sizeof(inv)) == 0;
+        if (!seen)
+            memcpy(builds[count++], inv, sizeof(inv));
+    }
+    return count;
+}
+
+static inline void CombatBossDamageRangeWith(const CombatParams *cp, int bossAttack, bool playerHasArmor, int *min, int *max)
+{
+    *min = bossAttack - cp->bossSpread;
+    *max = bossAttack + cp->bossSpread;
+
+    if (playerHasArmor)
+    {
+        *min = (bossAttack - cp->bossSpread) / cp->armorDivisor;
+        *max = (bossAttack + cp->bossSpread) / cp->armorDivisor;
+    }
+    if (*min < 1)
+        *min = 1;
+    if (*max < *min)
+        *max = *min;
+}
+
+static inline void CombatBossDamageRange(int bossAttack, bool playerHasArmor, int *min, int *max)
+{
+    CombatBossDamageRangeWith(&combatDefaults, bossAttack, playerHasArmor, min, max);
+}
+
+static inline void CombatPlayerDamageRangeWith(const CombatParams *cp, bool hasSword, int *min, int *max)
+{
+    *min = hasSword ? cp->swordMin : cp->unarmedMin;
+    *max = hasSword ? cp->swordMax : cp->unarmedMax;
+}
+
+static inline void CombatPlayerDamageRange(bool hasSword, int *min, int *max)
+{
+    CombatPlayerDamageRangeWith(&combatDefaults, hasSword, min, max);
+}
+
+static inline int CombatRollBossDamage(Rng *rng, int bossAttack, bool playerHasArmor)
+{
+    int min, max;
+    CombatBossDamageRange(bossAttack, playerHasArmor, &min, &max);
+    return RngRange(rng, min, max);
+}
+
+static inline int CombatRollPlayerDamage(Rng *rng, bool hasSword)
+{
+    int min, max;
+    CombatPlayerDamageRange(hasSword, &min, &max);
+    return RngRange(rng, min, max);
+}
+
+static inline int CombatRollBombDamage(Rng *rng)
+{
+    return RngRange(rng, BOMB_MIN_DAMAGE, BOMB_MAX_DAMAGE);
+}
+
+/* A fair coin uses one bit of one draw, as the game always has, so replays
+   and recorded seeds keep their outcomes. */
+static inline bool CombatRollCoinEscapeWith(const CombatParams *cp, Rng *rng)
+{
+    if (cp->coinEscapePercent == 50)
+        return (RngNext(rng) & 1) == 0;
+    return RngRange(rng, 0, 99) < cp->coinEscapePercent;
+}
+
+static inline bool CombatRollCoinEscape(Rng *rng)
+{
+    return CombatRollCoinEscapeWith(&combatDefaults, rng);
+}
+
+typedef enum
+{
+    BATTLE_ONGOING,
+    BATTLE_WON,
+    BATTLE_LOST,
+    BATTLE_ESCAPED
+} BattleOutcome;
+
+typedef enum
+{
+    ACTION_ATTACK = -1
+} BattleAction;
+
+/* Self-contained copy of the battle the game keeps in globals. itemUsed is a
+   bitmask over inventory slots. Actions are ACTION_ATTACK or a slot index. */
+typedef struct
+{
+    int playerHp;
+    int playerMaxHp;
+    int bossHp;
+    int bossMaxHp;
+    int bossAttack;
+    ItemType inventory[INVENTORY_SIZE];
+    unsigned char itemUsed;
+    bool playerHasArmor;
+    bool hasSword;
+    int turns;
+    BattleOutcome outcome;
+} Battle;
+
+static inline void BattleInitWith(const CombatParams *cp, Battle *b, const ItemType inventory[INVENTORY_SIZE])
+{
+    b->playerHp = cp->playerHp;
+    b->playerMaxHp = cp->playerHp;
+    b->bossHp = cp->bossHp;
+    b->bossMaxHp = cp->bossHp;
+    b->bossAttack = cp->bossAttack;
+    b->itemUsed = 0;
+    b->playerHasArmor = false;
+    b->hasSword = false;
+    b->turns = 0;
+    b->outcome = BATTLE_ONGOING;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        b->inventory[i] = inventory[i];
+        if (inventory[i] == ITEM_SWORD)
+            b->hasSword = true;
+    }
+}
+
+static inline void BattleInit(Battle *b, const ItemType inventory[INVENTORY_SIZE])
+{
+    BattleInitWith(&combatDefaults, b, inventory);
+}
+
+/* Returns false when the action does not spend the player's turn (used item,
+   sword slot), matching UseItem's early returns. */
+static inline bool BattlePlayerActWith(const CombatParams *cp, Battle *b, int action, Rng *rng)
+{
+    if (action == ACTION_ATTACK)
+    {
+        int min, max;
+        CombatPlayerDamageRangeWith(cp, b->hasSword, &min, &max);
+        b->bossHp -= RngRange(rng, min, max);
+    }
+    else
+    {
+        if (b->itemUsed & (1u << action))
+            return false;
+
+        switch (b->inventory[action])
+        {
+        case ITEM_POTION:
+            b->playerHp += cp->potionHeal;
+            if (b->playerHp > b->playerMaxHp)
+                b->playerHp = b->playerMaxHp;
+            b->itemUsed |= (unsigned char)(1u << action);
+            break;
+        case ITEM_SWORD:
+            return false;
+        case ITEM_BOMB:
+            b->bossHp -= RngRange(rng, cp->bombMin, cp->bombMax);
+            b->itemUsed |= (unsigned char)(1u << action);
+            break;
+        case ITEM_COIN:
+            b->itemUsed |= (unsigned char)(1u << action);
+            if (CombatRollCoinEscapeWith(cp, rng))
+            {
+                b->outcome = BATTLE_ESCAPED;
+                b->turns++;
+                return true;
+            }
+            break;
+        case ITEM_ARMOR:
+            b->playerHasArmor = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (b->bossHp < 0)
+        b->bossHp = 0;
+    b->turns++;
+    if (b->bossHp <= 0)
+        b->outcome = BATTLE_WON;
+    return true;
+}
+
+static inline bool BattlePlayerAct(Battle *b, int action, Rng *rng)
+{
+    return BattlePlayerActWith(&combatDefaults, b, action, rng);
+}
+
+/* Default policy of the headless tools: armor first, bomb as soon as
+   possible, then potion or coin once the next hit could be lethal. */
+static inline int CombatHeuristicActionWith(const CombatParams *cp, const Battle *b)
+{
+    int potion = -1, bomb = -1, coin = -1, armor = -1;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        if (b->itemUsed & (1u << i))
+            continue;
+        if (b->inventory[i] == ITEM_POTION && potion < 0)
+            potion = i;
+        if (b->inventory[i] == ITEM_BOMB && bomb < 0)
+            bomb = i;
+        if (b->inventory[i] == ITEM_COIN && coin < 0)
+            coin = i;
+        if (b->inventory[i] == ITEM_ARMOR && armor < 0)
+            armor = i;
+    }
+
+    int bossMin, bossMax;
+    CombatBossDamageRangeWith(cp, b->bossAttack, b->playerHasArmor, &bossMin, &bossMax);
+
+    if (armor >= 0 && !b->playerHasArmor)
+        return armor;
+    if (bomb >= 0)
+        return bomb;
+    if (b->playerHp <= bossMax && potion >= 0)
+        return potion;
+    if (b->playerHp <= bossMax && coin >= 0)
+        return coin;
+    return ACTION_ATTACK;
+}
+
+static inline int CombatHeuristicAction(const Battle *b)
+{
+    return CombatHeuristicActionWith(&combatDefaults, b);
+}
+
+static inline void BattleBossActWith(const CombatParams *cp, Battle *b, Rng *rng)
+{
+    int min, max;
+    CombatBossDamageRangeWith(cp, b->bossAttack, b->playerHasArmor, &min, &max);
+    b->playerHp -= RngRange(rng, min, max);
+    if (b->playerHp < 0)
+        b->playerHp = 0;
+    if (b->playerHp <= 0)
+        b->outcome = BATTLE_LOST;
+}
+
+static inline void BattleBossAct(Battle *b, Rng *rng)
+{
+    BattleBossActWith(&combatDefaults, b, rng);
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "anim.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define ENTITY_MAX 16384
+#define ENTITY_NONE -1
+
+/* Combatants stored as parallel arrays. Live entities are packed in
+   [0, count) so per-step loops touch only contiguous memory; handles stay
+   valid across removals through the handle -> slot table. Attack and hurt
+   are clips played in the store's animation pool; an entity is attacking
+   while its attack clip plays. */
+typedef struct
+{
+    int count;
+    int hp[ENTITY_MAX];
+    int maxHp[ENTITY_MAX];
+    int attack[ENTITY_MAX];
+    int attackClip[ENTITY_MAX];
+    int hurtClip[ENTITY_MAX];
+    int attackAnim[ENTITY_MAX];
+    int hurtAnim[ENTITY_MAX];
+
+    int handleOf[ENTITY_MAX];
+    int slotOf[ENTITY_MAX];
+    int freeHandles[ENTITY_MAX];
+    int freeCount;
+    int nextHandle;
+
+    AnimPool anims;
+} EntityStore;
+
+static inline void EntityStoreClear(EntityStore *s, const AnimClip *clips)
+{
+    s->count = 0;
+    s->freeCount = 0;
+    s->nextHandle = 0;
+    AnimPoolClear(&s->anims, clips);
+}
+
+static inline int EntityCreate(EntityStore *s, int hp, int attack)
+{
+    if (s->count >= ENTITY_MAX)
+        return ENTITY_NONE;
+    int h = (s->freeCount > 0) ? s->freeHandles[--s->freeCount] : s->nextHandle++;
+    int i = s->count++;
+
+    s->hp[i] = hp;
+    s->maxHp[i] = hp;
+    s->attack[i] = attack;
+    s->attackClip[i] = ANIM_NONE;
+    s->hurtClip[i] = ANIM_NONE;
+    s->attackAnim[i] = ANIM_NONE;
+    s->hurtAnim[i] = ANIM_NONE;
+
+    s->handleOf[i] = h;
+    s->slotOf[h] = i;
+    return h;
+}
+
+static inline int EntityIndex(const EntityStore *s, int h)
+{
+    return (h >= 0 && h < s->nextHandle) ? s->slotOf[h] : ENTITY_NONE;
+}
+
+/* Moves the last entity into the freed slot to keep the arrays packed. */
+static inline void EntityDestroy(EntityStore *s, int h)
+{
+    int i = EntityIndex(s, h);
+    if (i == ENTITY_NONE)
+        return;
+    AnimStop(&s->anims, s->attackAnim[i]);
+    AnimStop(&s->anims, s->hurtAnim[i]);
+    int last = --s->count;
+    if (i != last)
+    {
+        s->hp[i] = s->hp[last];
+        s->maxHp[i] = s->maxHp[last];
+        s->attack[i] = s->attack[last];
+        s->attackClip[i] = s->attackClip[last];
+        s->hurtClip[i] = s->hurtClip[last];
+        s->attackAnim[i] = s->attackAnim[last];
+        s->hurtAnim[i] = s->hurtAnim[last];
+        s->handleOf[i] = s->handleOf[last];
+        s->slotOf[s->handleOf[i]] = i;
+    }
+    s->slotOf[h] = ENTITY_NONE;
+    s->freeHandles[s->freeCount++] = h;
+}
+
+static inline void EntitySetClips(EntityStore *s, int i, int attackClip, int hurtClip)
+{
+    s->attackClip[i] = attackClip;
+    s->hurtClip[i] = hurtClip;
+}
+
+static inline bool EntityIsAttacking(const EntityStore *s, int i)
+{
+    return AnimIsPlaying(&s->anims, s->attackAnim[i]);
+}
+
+static inline void EntityStartAttack(EntityStore *s, int i)
+{
+    if (s->attackClip[i] != ANIM_NONE)
+        s->attackAnim[i] = AnimPlay(&s->anims, s->attackAnim[i], s->attackClip[i]);
+}
+
+static inline void EntityHurt(EntityStore *s, int i)
+{
+    if (s->hurtClip[i] != ANIM_NONE)
+        s->hurtAnim[i] = AnimPlay(&s->anims, s->hurtAnim[i], s->hurtClip[i]);
+}
+
+/* Advances every playing clip in one pass; idle entities cost nothing. */
+static inline void EntityTick(EntityStore *s, float delta)
+{
+    AnimTick(&s->anims, delta);
+}
+
+#endif
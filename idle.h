@@ -0,0 +1,40 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define IDLE_NO_DEADLINE -1.0
+#define IDLE_POLL_INTERVAL (1.0 / 60.0)
+
+/* Returns, without drawing anything, once something could change a static
+   screen: a key press, a resize, a focus change, a close request or the
+   deadline (on GetTime's clock). With no deadline the thread sleeps in the
+   window system's event wait; with one it naps in short steps so input is
+   still read at the usual frame rate. */
+static inline void IdleWait(double deadline)
+{
+    bool focused = IsWindowFocused();
+    for (;;)
+    {
+        if (deadline == IDLE_NO_DEADLINE)
+        {
+            EnableEventWaiting();
+            PollInputEvents();
+            DisableEventWaiting();
+        }
+        else
+        {
+            double remaining = deadline - GetTime();
+            if (remaining <= 0.0)
+                return;
+            WaitTime(remaining < IDLE_POLL_INTERVAL ? remaining : IDLE_POLL_INTERVAL);
+            PollInputEvents();
+        }
+
+        if (GetKeyPressed() != 0 || IsWindowResized() || IsWindowFocused() != focused || WindowShouldClose())
+            return;
+    }
+}
+
+#endif
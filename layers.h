@@ -0,0 +1,93 @@
+#ifndef LAYERS_H
+#define LAYERS_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LAYER_KEY_SEED 14695981039346656037ull
+
+/* A cached piece of screen: drawn into its own render texture when its key
+   changes and composited with a single quad every frame. Callers draw in
+   screen coordinates; the layer offsets them to its bounds and renders at
+   layerPixelScale output pixels per unit, so it stays sharp when the window
+   is larger than the game. Only opaque content belongs in a layer,
+   translucent fills would be blended twice. */
+typedef struct
+{
+    RenderTexture2D target;
+    Rectangle bounds;
+    float pixelScale;
+    uint64_t key;
+    bool valid;
+} Layer;
+
+static float layerPixelScale = 1.0f;
+
+static uint64_t LayerHash(uint64_t key, const void *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        key ^= p[i];
+        key *= 1099511628211ull;
+    }
+    return key;
+}
+
+static uint64_t LayerHashInt(uint64_t key, int value)
+{
+    return LayerHash(key, &value, sizeof(value));
+}
+
+/* Returns true when the layer must be redrawn; the caller then draws its
+   contents and calls LayerEnd. Call it outside any other texture mode. */
+static bool LayerBegin(Layer *layer, Rectangle bounds, uint64_t key)
+{
+    if (layer->valid && layer->key == key && layer->pixelScale == layerPixelScale)
+        return false;
+
+    int width = (int)(bounds.width * layerPixelScale + 0.5f), height = (int)(bounds.height * layerPixelScale + 0.5f);
+    if (layer->target.id == 0 || layer->target.texture.width != width || layer->target.texture.height != height)
+    {
+        if (layer->target.id)
+            UnloadRenderTexture(layer->target);
+        layer->target = LoadRenderTexture(width, height);
+    }
+    layer->bounds = bounds;
+    layer->pixelScale = layerPixelScale;
+    layer->key = key;
+    layer->valid = true;
+
+    BeginTextureMode(layer->target);
+    ClearBackground(BLANK);
+    rlPushMatrix();
+    rlScalef(width / bounds.width, height / bounds.height, 1.0f);
+    rlTranslatef(-bounds.x, -bounds.y, 0.0f);
+    return true;
+}
+
+static void LayerEnd(void)
+{
+    rlPopMatrix();
+    EndTextureMode();
+}
+
+static void LayerDraw(const Layer *layer)
+{
+    if (!layer->valid)
+        return;
+    Texture2D t = layer->target.texture;
+    DrawTexturePro(t, (Rectangle){0, 0, (float)t.width, -(float)t.height}, layer->bounds, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+static void LayerUnload(Layer *layer)
+{
+    if (layer->target.id)
+        UnloadRenderTexture(layer->target);
+    memset(layer, 0, sizeof(*layer));
+}
+
+#endif
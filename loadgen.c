@@ -0,0 +1,293 @@
+#include "combat.h"
+#include "netproto.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+#define MAX_EVENTS 256
+#define MAX_BUILDS (1 << STAGE_COUNT)
+#define LATENCY_FINE_US 10000   /* 1 us buckets up to 10 ms */
+#define LATENCY_COARSE_US 100   /* then 100 us buckets up to 10 s */
+#define LATENCY_BUCKETS (LATENCY_FINE_US + 10000000 / LATENCY_COARSE_US)
+
+/* One simulated player. It keeps a copy of its battle rebuilt from the
+   server's replies so it can pick moves with the same heuristic as sim.c. */
+typedef struct
+{
+    int fd;
+    Battle battle;
+    double sentAt;
+    uint8_t in[sizeof(NetResponse)];
+    int inLen;
+    bool acting;
+} Client;
+
+typedef struct
+{
+    int id;
+    int first;
+    int count;
+    long long turns;
+    long long battles;
+    long long errors;
+    uint32_t latency[LATENCY_BUCKETS];
+} LoadThread;
+
+static ItemType builds[MAX_BUILDS][INVENTORY_SIZE];
+static int buildCount;
+static Client *clients;
+static LoadThread threads[MAX_THREADS];
+static const char *socketPath = NET_DEFAULT_SOCKET;
+static int port = 0;
+static double deadline;
+static uint64_t baseSeed;
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int LatencyBucket(double us)
+{
+    int bucket = us < LATENCY_FINE_US ? (int)us : LATENCY_FINE_US + (int)((us - LATENCY_FINE_US) / LATENCY_COARSE_US);
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static double BucketUs(int bucket)
+{
+    return bucket < LATENCY_FINE_US ? bucket : LATENCY_FINE_US + (double)(bucket - LATENCY_FINE_US) * LATENCY_COARSE_US;
+}
+
+static bool Send(Client *c, const NetRequest *req)
+{
+    c->sentAt = Now();
+    return send(c->fd, req, sizeof(*req), MSG_NOSIGNAL) == (ssize_t)sizeof(*req);
+}
+
+static bool SendStart(Client *c, int index, long long battle)
+{
+    NetRequest req;
+    memset(&req, 0, sizeof(req));
+    req.type = NET_REQ_START;
+    const ItemType *inventory = builds[index % buildCount];
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+        req.inventory[i] = (uint8_t)inventory[i];
+    uint64_t mix = baseSeed ^ ((uint64_t)index << 32) ^ (uint64_t)battle;
+    req.seed = RngSplitMix(&mix) | 1;
+    BattleInit(&c->battle, inventory);
+    c->acting = false;
+    return Send(c, &req);
+}
+
+static bool SendAction(Client *c, int action)
+{
+    NetRequest req;
+    memset(&req, 0, sizeof(req));
+    req.type = NET_REQ_ACT;
+    req.action = (int8_t)action;
+    c->acting = true;
+    return Send(c, &req);
+}
+
+/* Applies one reply and sends the next request: another action, an attack
+   when the chosen item did not spend the turn, or a new battle. */
+static bool HandleResponse(LoadThread *t, Client *c, int index, const NetResponse *res)
+{
+    if (c->acting)
+        t->latency[LatencyBucket((Now() - c->sentAt) * 1e6)]++;
+
+    if (res->status == NET_TURN_NOT_SPENT)
+        return SendAction(c, ACTION_ATTACK);
+    if (res->status != NET_OK)
+    {
+        t->errors++;
+        return SendStart(c, index, t->battles);
+    }
+
+    Battle *b = &c->battle;
+    b->playerHp = res->playerHp;
+    b->bossHp = res->bossHp;
+    b->itemUsed = res->itemUsed;
+    b->playerHasArmor = res->playerHasArmor != 0;
+    b->turns = (int)res->turns;
+    b->outcome = (BattleOutcome)res->outcome;
+
+    if (c->acting)
+        t->turns++;
+    if (b->outcome != BATTLE_ONGOING)
+    {
+        t->battles++;
+        return SendStart(c, index, t->battles);
+    }
+    return SendAction(c, CombatHeuristicAction(b));
+}
+
+static void *LoadMain(void *arg)
+{
+    LoadThread *t = (LoadThread *)arg;
+    int epollFd = epoll_create1(0);
+    if (epollFd < 0)
+        return NULL;
+
+    for (int i = t->first; i < t->first + t->count; i++)
+    {
+        Client *c = &clients[i];
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)i;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, c->fd, &ev) != 0 || !SendStart(c, i, 0))
+            t->errors++;
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    while (Now() < deadline)
+    {
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, 100);
+        for (int e = 0; e < n; e++)
+        {
+            int i = (int)events[e].data.u32;
+            Client *c = &clients[i];
+            ssize_t got = recv(c->fd, c->in + c->inLen, sizeof(c->in) - (size_t)c->inLen, 0);
+            if (got <= 0)
+            {
+                if (got < 0 && (errno == EAGAIN || errno == EINTR))
+                    continue;
+                t->errors++;
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, NULL);
+                continue;
+            }
+            c->inLen += (int)got;
+            if (c->inLen < (int)sizeof(NetResponse))
+                continue;
+            c->inLen = 0;
+
+            NetResponse res;
+            memcpy(&res, c->in, sizeof(res));
+            if (!HandleResponse(t, c, i, &res))
+                t->errors++;
+        }
+    }
+    close(epollFd);
+    return NULL;
+}
+
+static double Percentile(const uint32_t *latency, long long total, double pct)
+{
+    long long target = (long long)(total * pct);
+    long long seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += latency[i];
+        if (seen > target)
+            return BucketUs(i);
+    }
+    return BucketUs(LATENCY_BUCKETS - 1);
+}
+
+int main(int argc, char **argv)
+{
+    int sessionCount = 10000;
+    int threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double seconds = 10.0;
+    baseSeed = (uint64_t)time(NULL);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc)
+            sessionCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            baseSeed = strtoull(argv[++i], NULL, 10);
+        else
+        {
+            fprintf(stderr, "uso: %s [--socket caminho | --tcp porta] [--sessions N] [--threads N] [--seconds S] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sessionCount < 1)
+        sessionCount = 1;
+    if (threadCount < 1)
+        threadCount = 1;
+    if (threadCount > MAX_THREADS)
+        threadCount = MAX_THREADS;
+    if (threadCount > sessionCount)
+        threadCount = sessionCount;
+
+    NetRaiseFileLimit();
+    buildCount = CombatEnumerateBuilds(builds, MAX_BUILDS);
+    clients = calloc((size_t)sessionCount, sizeof(Client));
+    if (!clients)
+        return 1;
+
+    for (int i = 0; i < sessionCount; i++)
+    {
+        clients[i].fd = NetConnect(socketPath, port);
+        if (clients[i].fd < 0 || !NetSetNonBlocking(clients[i].fd))
+        {
+            fprintf(stderr, "conexao %d falhou: %s\n", i, strerror(errno));
+            return 1;
+        }
+    }
+    printf("%d sessoes abertas, %d threads, %.0f s\n", sessionCount, threadCount, seconds);
+    fflush(stdout);
+
+    double start = Now();
+    deadline = start + seconds;
+    pthread_t handles[MAX_THREADS];
+    int per = sessionCount / threadCount, extra = sessionCount % threadCount, next = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads[i].id = i;
+        threads[i].first = next;
+        threads[i].count = per + (i < extra ? 1 : 0);
+        next += threads[i].count;
+        pthread_create(&handles[i], NULL, LoadMain, &threads[i]);
+    }
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(handles[i], NULL);
+    double elapsed = Now() - start;
+
+    static uint32_t latency[LATENCY_BUCKETS];
+    long long turns = 0, battles = 0, errors = 0, samples = 0;
+    int slowest = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        turns += threads[i].turns;
+        battles += threads[i].battles;
+        errors += threads[i].errors;
+        for (int b = 0; b < LATENCY_BUCKETS; b++)
+        {
+            latency[b] += threads[i].latency[b];
+            samples += threads[i].latency[b];
+            if (threads[i].latency[b] && b > slowest)
+                slowest = b;
+        }
+    }
+
+    printf("%lld turnos, %lld batalhas em %.2f s: %.0f turnos/s\n", turns, battles, elapsed, turns / elapsed);
+    if (samples > 0)
+        printf("latencia por turno: p50 %.0f us, p99 %.0f us, max %.0f us%s\n", Percentile(latency, samples, 0.50),
+               Percentile(latency, samples, 0.99), BucketUs(slowest), slowest == LATENCY_BUCKETS - 1 ? "+" : "");
+    if (errors > 0)
+        printf("%lld erros\n", errors);
+
+    for (int i = 0; i < sessionCount; i++)
+        close(clients[i].fd);
+    free(clients);
+    return errors > 0 ? 1 : 0;
+}
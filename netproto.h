@@ -0,0 +1,118 @@
+#ifndef NETPROTO_H
+#define NETPROTO_H
+
+#include "combat.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define NET_DEFAULT_SOCKET "/tmp/rush_rpg.sock"
+
+typedef enum
+{
+    NET_REQ_START = 1,
+    NET_REQ_ACT = 2
+} NetRequestType;
+
+typedef enum
+{
+    NET_OK,
+    NET_TURN_NOT_SPENT,
+    NET_NO_BATTLE,
+    NET_BAD_REQUEST
+} NetStatus;
+
+/* Requests and responses are fixed 16-byte little-endian records. A client
+   may pipeline requests; the server answers each one in order. START begins
+   a new battle with the given inventory (seed 0 lets the server pick one).
+   ACT plays one player action, ACTION_ATTACK or an inventory slot, and the
+   boss's reply if the battle goes on. NET_TURN_NOT_SPENT mirrors UseItem's
+   early returns: nothing happened and it is still the player's turn. */
+typedef struct
+{
+    uint8_t type;
+    int8_t action;
+    uint8_t inventory[INVENTORY_SIZE];
+    uint16_t reserved;
+    uint64_t seed;
+} NetRequest;
+
+typedef struct
+{
+    uint8_t status;
+    uint8_t outcome;
+    uint8_t itemUsed;
+    uint8_t playerHasArmor;
+    int16_t playerHp;
+    int16_t bossHp;
+    int16_t damageDealt;
+    int16_t damageTaken;
+    uint32_t turns;
+} NetResponse;
+
+static inline bool NetSetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/* Thousands of sessions need thousands of descriptors; lift the soft limit
+   to the hard one. */
+static inline void NetRaiseFileLimit(void)
+{
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/* Connects to the Unix socket at path, or to 127.0.0.1:port when port > 0. */
+static inline int NetConnect(const char *path, int port)
+{
+    int fd;
+    if (port > 0)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+#endif
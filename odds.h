@@ -0,0 +1,264 @@
+#ifndef ODDS_H
+#define ODDS_H
+
+#include "raylib.h"
+#include "combat.h"
+#include "policy.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ODDS_MAX_DAMAGES 64
+#define ODDS_LAYERS ((1 << INVENTORY_SIZE) * 2)
+
+/* Exact distribution of RngRange(min, max): value min + k comes out for the
+   hi words in [ceil(k * 2^32 / n), ceil((k + 1) * 2^32 / n)). */
+typedef struct
+{
+    int min;
+    int count;
+    float weight[ODDS_MAX_DAMAGES];
+} OddsPmf;
+
+/* Win chances of one build, filled on demand a boss-hp row at a time. Row b
+   holds every player hp of every layer (spent-item mask, armor) the build
+   can reach; it only reads rows <= b, and the boss's hp never grows, so once
+   the rows up to the battle's boss hp exist every later state of the battle
+   is already known. Values use the solver's layout (PolicyIndex). */
+typedef struct
+{
+    ItemType inventory[INVENTORY_SIZE];
+    bool hasBuild;
+    bool hasSword;
+    bool hasArmor;
+    unsigned spendable;
+    OddsPmf attack;
+    OddsPmf bomb;
+    OddsPmf boss[2];
+    int layers[ODDS_LAYERS];
+    int layerCount;
+    int rowsDone;
+    float *turnValue;
+    float *bossValue;
+    long long statesEvaluated;
+} OddsTable;
+
+static inline void OddsPmfInit(OddsPmf *pmf, int min, int max)
+{
+    uint64_t n = (uint64_t)(max - min + 1);
+    pmf->min = min;
+    pmf->count = (int)n;
+    for (uint64_t k = 0; k < n && k < ODDS_MAX_DAMAGES; k++)
+    {
+        uint64_t from = ((k << 32) + n - 1) / n;
+        uint64_t to = (((k + 1) << 32) + n - 1) / n;
+        pmf->weight[k] = (float)((double)(to - from) / 4294967296.0);
+    }
+    if (pmf->count > ODDS_MAX_DAMAGES)
+        pmf->count = ODDS_MAX_DAMAGES;
+}
+
+/* Chance of winning once the player has acted and the boss is about to. */
+static inline float OddsBossTurn(const OddsTable *t, int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    if (bossHp <= 0)
+        return 1.0f;
+    return t->bossValue[PolicyIndex(playerHp, bossHp, mask, armor)];
+}
+
+static inline float OddsAfterHit(const OddsTable *t, const OddsPmf *pmf, int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    float sum = 0.0f;
+    for (int k = 0; k < pmf->count; k++)
+        sum += pmf->weight[k] * OddsBossTurn(t, playerHp, bossHp - (pmf->min + k), mask, armor);
+    return sum;
+}
+
+/* Best action on the player's turn, mirroring UseItem: used items and the
+   sword do not spend the turn, armor is never marked used, an empty slot
+   wastes the turn and escaping with the coin does not count as a win. */
+static inline float OddsPlayerTurn(const OddsTable *t, int playerHp, int bossHp, unsigned mask, bool armor, int *action)
+{
+    float best = OddsAfterHit(t, &t->attack, playerHp, bossHp, mask, armor);
+    int bestAction = ACTION_ATTACK;
+    float wasted = t->bossValue[PolicyIndex(playerHp, bossHp, mask, armor)];
+
+    for (int s = 0; s < INVENTORY_SIZE; s++)
+    {
+        unsigned bit = 1u << s;
+        if (mask & bit)
+            continue;
+
+        float v;
+        switch (t->inventory[s])
+        {
+        case ITEM_POTION:
+        {
+            int healed = playerHp + POTION_HEAL;
+            if (healed > PLAYER_START_HP)
+                healed = PLAYER_START_HP;
+            v = OddsBossTurn(t, healed, bossHp, mask | bit, armor);
+            break;
+        }
+        case ITEM_SWORD:
+            continue;
+        case ITEM_BOMB:
+            v = OddsAfterHit(t, &t->bomb, playerHp, bossHp, mask | bit, armor);
+            break;
+        case ITEM_COIN:
+            v = (1.0f - COIN_ESCAPE_PERCENT / 100.0f) * OddsBossTurn(t, playerHp, bossHp, mask | bit, armor);
+            break;
+        case ITEM_ARMOR:
+            v = OddsBossTurn(t, playerHp, bossHp, mask, true);
+            break;
+        default:
+            v = wasted;
+            break;
+        }
+
+        if (v > best + 1e-6f)
+        {
+            best = v;
+            bestAction = s;
+        }
+    }
+
+    if (action)
+        *action = bestAction;
+    return best;
+}
+
+static inline void OddsFillRow(OddsTable *t, int bossHp)
+{
+    for (int l = 0; l < t->layerCount; l++)
+    {
+        unsigned mask = (unsigned)t->layers[l] >> 1;
+        bool armor = (t->layers[l] & 1) != 0;
+        const OddsPmf *boss = &t->boss[armor ? 1 : 0];
+
+        for (int p = 0; p < POLICY_PLAYER_HP; p++)
+        {
+            int idx = PolicyIndex(p, bossHp, mask, armor);
+            if (bossHp == 0 || p == 0)
+            {
+                t->turnValue[idx] = (bossHp == 0) ? 1.0f : 0.0f;
+                t->bossValue[idx] = t->turnValue[idx];
+                continue;
+            }
+
+            float sum = 0.0f;
+            for (int k = 0; k < boss->count; k++)
+            {
+                int hp = p - (boss->min + k);
+                if (hp > 0)
+                    sum += boss->weight[k] * t->turnValue[PolicyIndex(hp, bossHp, mask, armor)];
+            }
+            t->bossValue[idx] = sum;
+            t->turnValue[idx] = OddsPlayerTurn(t, p, bossHp, mask, armor, NULL);
+        }
+        t->statesEvaluated += POLICY_PLAYER_HP;
+    }
+}
+
+/* Switches the table to a new build. Rows already filled for the same build
+   are kept, so replaying it costs nothing. */
+static inline bool OddsSetBuild(OddsTable *t, const ItemType inventory[INVENTORY_SIZE])
+{
+    if (t->hasBuild && memcmp(t->inventory, inventory, sizeof(t->inventory)) == 0)
+        return true;
+
+    if (!t->turnValue)
+    {
+        t->turnValue = malloc(sizeof(float) * POLICY_STATES);
+        t->bossValue = malloc(sizeof(float) * POLICY_STATES);
+        if (!t->turnValue || !t->bossValue)
+        {
+            free(t->turnValue);
+            free(t->bossValue);
+            t->turnValue = t->bossValue = NULL;
+            return false;
+        }
+    }
+
+    memcpy(t->inventory, inventory, sizeof(t->inventory));
+    t->hasBuild = true;
+    t->hasSword = t->hasArmor = false;
+    t->spendable = 0;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        if (inventory[i] == ITEM_SWORD)
+            t->hasSword = true;
+        else if (inventory[i] == ITEM_ARMOR)
+            t->hasArmor = true;
+        else if (inventory[i] != ITEM_NONE)
+            t->spendable |= 1u << i;
+    }
+
+    int min, max;
+    CombatPlayerDamageRange(t->hasSword, &min, &max);
+    OddsPmfInit(&t->attack, min, max);
+    OddsPmfInit(&t->bomb, BOMB_MIN_DAMAGE, BOMB_MAX_DAMAGE);
+    for (int armor = 0; armor < 2; armor++)
+    {
+        CombatBossDamageRange(BOSS_START_ATTACK, armor, &min, &max);
+        OddsPmfInit(&t->boss[armor], min, max);
+    }
+
+    /* Layers that spend more items and the armored half come first, so every
+       layer a row reads from is filled before it. */
+    t->layerCount = 0;
+    for (int mask = (1 << INVENTORY_SIZE) - 1; mask >= 0; mask--)
+    {
+        if ((unsigned)mask & ~t->spendable)
+            continue;
+        for (int armor = t->hasArmor ? 1 : 0; armor >= 0; armor--)
+            t->layers[t->layerCount++] = mask * 2 + armor;
+    }
+    t->rowsDone = 0;
+    return true;
+}
+
+/* Fills rows up to bossHp until budget seconds have passed and reports
+   whether that state can be looked up yet. */
+static inline bool OddsAdvance(OddsTable *t, int bossHp, double budget)
+{
+    if (!t->hasBuild || bossHp < 0 || bossHp >= POLICY_BOSS_HP)
+        return false;
+
+    double start = GetTime();
+    while (t->rowsDone <= bossHp)
+    {
+        OddsFillRow(t, t->rowsDone++);
+        if (t->rowsDone <= bossHp && GetTime() - start >= budget)
+            return false;
+    }
+    return true;
+}
+
+/* False until OddsAdvance has reached bossHp, or for states the build cannot
+   reach. */
+static inline bool OddsLookup(const OddsTable *t, int playerHp, int bossHp, unsigned mask, bool armor, bool playerTurn, float *win,
+                              int *action)
+{
+    if (!t->hasBuild || bossHp >= t->rowsDone || playerHp < 0 || playerHp >= POLICY_PLAYER_HP || (mask & ~t->spendable) ||
+        (armor && !t->hasArmor))
+        return false;
+
+    *action = ACTION_ATTACK;
+    if (bossHp <= 0 || playerHp <= 0)
+        *win = bossHp <= 0 ? 1.0f : 0.0f;
+    else if (playerTurn)
+        *win = OddsPlayerTurn(t, playerHp, bossHp, mask, armor, action);
+    else
+        *win = OddsBossTurn(t, playerHp, bossHp, mask, armor);
+    return true;
+}
+
+static inline void OddsFree(OddsTable *t)
+{
+    free(t->turnValue);
+    free(t->bossValue);
+    memset(t, 0, sizeof(*t));
+}
+
+#endif
@@ -0,0 +1,338 @@
+#include "raylib.h"
+#include "pack.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_ASSETS 128
+
+typedef struct
+{
+    PackEntry entry;
+    Image image;
+} PackItem;
+
+static PackItem items[MAX_ASSETS];
+static int itemCount = 0;
+static int maxWidth = PACK_SCREEN_WIDTH;
+static int maxHeight = PACK_SCREEN_HEIGHT;
+
+static bool HasImageExtension(const char *file)
+{
+    const char *dot = strrchr(file, '.');
+    return dot && (strcmp(dot, ".png") == 0 || strcmp(dot, ".jpg") == 0 || strcmp(dot, ".bmp") == 0);
+}
+
+static bool IsOpaque(Image image)
+{
+    const unsigned char *px = (const unsigned char *)image.data;
+    for (int i = 0; i < image.width * image.height; i++)
+    {
+        if (px[i * 4 + 3] != 255)
+            return false;
+    }
+    return true;
+}
+
+static uint16_t PackRgb565(const unsigned char *c)
+{
+    return (uint16_t)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+static void UnpackRgb565(uint16_t v, int *c)
+{
+    c[0] = ((v >> 11) & 31) * 255 / 31;
+    c[1] = ((v >> 5) & 63) * 255 / 63;
+    c[2] = (v & 31) * 255 / 31;
+}
+
+/* Plain BC1: endpoints are the darkest and brightest texels of the block,
+   every texel picks the nearest of the four palette colors. */
+static void CompressBlockDxt1(const unsigned char block[16][4], uint8_t out[8])
+{
+    int lo = 0, hi = 0;
+    int loLum = 1 << 30, hiLum = -1;
+    for (int i = 0; i < 16; i++)
+    {
+        int lum = block[i][0] * 299 + block[i][1] * 587 + block[i][2] * 114;
+        if (lum < loLum)
+        {
+            loLum = lum;
+            lo = i;
+        }
+        if (lum > hiLum)
+        {
+            hiLum = lum;
+            hi = i;
+        }
+    }
+
+    uint16_t c0 = PackRgb565(block[hi]);
+    uint16_t c1 = PackRgb565(block[lo]);
+    if (c0 < c1)
+    {
+        uint16_t t = c0;
+        c0 = c1;
+        c1 = t;
+    }
+
+    int palette[4][3];
+    UnpackRgb565(c0, palette[0]);
+    UnpackRgb565(c1, palette[1]);
+    for (int k = 0; k < 3; k++)
+    {
+        palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+        palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, bestDist = 1 << 30;
+            for (int p = 0; p < 4; p++)
+            {
+                int dr = block[i][0] - palette[p][0];
+                int dg = block[i][1] - palette[p][1];
+                int db = block[i][2] - palette[p][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if (dist < bestDist)
+                {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    out[0] = (uint8_t)(c0 & 0xFF);
+    out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)(c1 & 0xFF);
+    out[3] = (uint8_t)(c1 >> 8);
+    out[4] = (uint8_t)(indices & 0xFF);
+    out[5] = (uint8_t)((indices >> 8) & 0xFF);
+    out[6] = (uint8_t)((indices >> 16) & 0xFF);
+    out[7] = (uint8_t)(indices >> 24);
+}
+
+static Image CompressDxt1(Image rgba)
+{
+    int bw = rgba.width / 4, bh = rgba.height / 4;
+    Image out = {0};
+    out.data = malloc((size_t)bw * bh * 8);
+    out.width = rgba.width;
+    out.height = rgba.height;
+    out.mipmaps = 1;
+    out.format = PIXELFORMAT_COMPRESSED_DXT1_RGB;
+
+    const unsigned char *px = (const unsigned char *)rgba.data;
+    uint8_t *dst = (uint8_t *)out.data;
+    for (int by = 0; by < bh; by++)
+    {
+        for (int bx = 0; bx < bw; bx++)
+        {
+            unsigned char block[16][4];
+            for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++)
+                    memcpy(block[y * 4 + x], px + ((size_t)(by * 4 + y) * rgba.width + bx * 4 + x) * 4, 4);
+            CompressBlockDxt1(block, dst);
+            dst += 8;
+        }
+    }
+    return out;
+}
+
+static void AddAsset(const char *path, const char *name, bool dxt)
+{
+    if (itemCount >= MAX_ASSETS || strlen(name) >= PACK_NAME_SIZE)
+    {
+        fprintf(stderr, "Ignorando %s\n", path);
+        return;
+    }
+
+    Image image = LoadImage(path);
+    if (image.data == NULL)
+        return;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    if (strncmp(name, "cenarios/", 9) == 0 && (image.width > maxWidth || image.height > maxHeight))
+        ImageResize(&image, image.width > maxWidth ? maxWidth : image.width,
+                    image.height > maxHeight ? maxHeight : image.height);
+
+    /* DXT1 needs whole 4x4 blocks: round up, or down where rounding up would
+       pass the max size. */
+    if (dxt && strncmp(name, "cenarios/", 9) == 0 && IsOpaque(image))
+    {
+        int width = (image.width + 3) / 4 * 4, height = (image.height + 3) / 4 * 4;
+        if (width > maxWidth)
+            width = image.width / 4 * 4;
+        if (height > maxHeight)
+            height = image.height / 4 * 4;
+        if (width != image.width || height != image.height)
+            ImageResize(&image, width, height);
+        Image compressed = CompressDxt1(image);
+        UnloadImage(image);
+        image = compressed;
+    }
+
+    PackItem *item = &items[itemCount++];
+    memset(item, 0, sizeof(*item));
+    strcpy(item->entry.name, name);
+    item->entry.width = image.width;
+    item->entry.height = image.height;
+    item->entry.format = image.format;
+    item->entry.mipmaps = 1;
+    item->entry.size = (uint64_t)GetPixelDataSize(image.width, image.height, image.format);
+    item->image = image;
+}
+
+static void ScanDir(const char *root, const char *rel, bool dxt)
+{
+    char dirPath[512];
+    snprintf(dirPath, sizeof(dirPath), "%s/%s", root, rel);
+    DIR *dir = opendir(dirPath);
+    if (!dir)
+        return;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (ent->d_name[0] == '.')
+            continue;
+
+        char childRel[512], childPath[1024];
+        snprintf(childRel, sizeof(childRel), "%s%s%s", rel, rel[0] ? "/" : "", ent->d_name);
+        snprintf(childPath, sizeof(childPath), "%s/%s", root, childRel);
+
+        struct stat st;
+        if (stat(childPath, &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+        {
+            ScanDir(root, childRel, dxt);
+        }
+        else if (HasImageExtension(ent->d_name))
+        {
+            char name[512];
+            strcpy(name, childRel);
+            *strrchr(name, '.') = '\0';
+            AddAsset(childPath, name, dxt);
+        }
+    }
+    closedir(dir);
+}
+
+static int CompareItems(const void *a, const void *b)
+{
+    return strcmp(((const PackItem *)a)->entry.name, ((const PackItem *)b)->entry.name);
+}
+
+static int Usage(void)
+{
+    fprintf(stderr, "uso: rush_pack [--dxt] [--max-size L A] [--assets pasta] [--out arquivo]\n");
+    return 1;
+}
+
+/* A whole positive decimal number, or 0. */
+static int ParseSize(const char *text)
+{
+    char *end;
+    long value = strtol(text, &end, 10);
+    return (end != text && *end == '\0' && value > 0 && value <= PACK_MAX_DIMENSION) ? (int)value : 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *root = "assets";
+    const char *outPath = PACK_DEFAULT_PATH;
+    bool dxt = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dxt") == 0)
+            dxt = true;
+        else if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc)
+            root = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (strcmp(argv[i], "--max-size") == 0 && i + 2 < argc)
+        {
+            maxWidth = ParseSize(argv[++i]);
+            maxHeight = ParseSize(argv[++i]);
+            if (maxWidth == 0 || maxHeight == 0)
+            {
+                fprintf(stderr, "--max-size precisa de largura e altura positivas\n");
+                return Usage();
+            }
+        }
+        else
+        {
+            fprintf(stderr, "argumento invalido: %s\n", argv[i]);
+            return Usage();
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    ScanDir(root, "", dxt);
+    qsort(items, (size_t)itemCount, sizeof(PackItem), CompareItems);
+    for (int i = 1; i < itemCount; i++)
+    {
+        if (strcmp(items[i - 1].entry.name, items[i].entry.name) == 0)
+        {
+            fprintf(stderr, "Duas imagens para %s (mesmo nome com extensoes diferentes)\n", items[i].entry.name);
+            return 1;
+        }
+    }
+
+    uint64_t offset = sizeof(PackHeader) + (uint64_t)itemCount * sizeof(PackEntry);
+    for (int i = 0; i < itemCount; i++)
+    {
+        offset = (offset + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN;
+        items[i].entry.offset = offset;
+        offset += items[i].entry.size;
+    }
+
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", outPath);
+    FILE *f = fopen(tmpPath, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Erro ao criar %s\n", tmpPath);
+        return 1;
+    }
+
+    PackHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, PACK_MAGIC, 4);
+    h.version = PACK_VERSION;
+    h.entryCount = (uint32_t)itemCount;
+    fwrite(&h, sizeof(h), 1, f);
+    for (int i = 0; i < itemCount; i++)
+        fwrite(&items[i].entry, sizeof(PackEntry), 1, f);
+
+    static const uint8_t zeros[PACK_ALIGN] = {0};
+    for (int i = 0; i < itemCount; i++)
+    {
+        long pos = ftell(f);
+        fwrite(zeros, 1, (size_t)((long)items[i].entry.offset - pos), f);
+        fwrite(items[i].image.data, 1, (size_t)items[i].entry.size, f);
+        printf("%-28s %5dx%-5d %s %8llu bytes\n", items[i].entry.name, items[i].entry.width, items[i].entry.height,
+               items[i].entry.format == PIXELFORMAT_COMPRESSED_DXT1_RGB ? "DXT1" : "RGBA",
+               (unsigned long long)items[i].entry.size);
+        UnloadImage(items[i].image);
+    }
+
+    bool ok = ferror(f) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmpPath, outPath) != 0)
+    {
+        fprintf(stderr, "Erro ao salvar %s\n", outPath);
+        return 1;
+    }
+    printf("%d imagens gravadas em %s (%llu bytes)\n", itemCount, outPath, (unsigned long long)offset);
+    return 0;
+}
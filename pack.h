@@ -0,0 +1,188 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include "raylib.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define PACK_MAGIC "RRPK"
+#define PACK_VERSION 1
+#define PACK_NAME_SIZE 48
+#define PACK_ALIGN 64
+#define PACK_DEFAULT_PATH "assets/assets.rrpk"
+#define PACK_MAX_DIMENSION 16384
+
+/* The game's logical screen. Backgrounds are never drawn larger, so the
+   game streams cenarios/ at most this size and the packer stores them at
+   it, letting packed pixels reach the GPU without a resize. */
+#define PACK_SCREEN_WIDTH 1000
+#define PACK_SCREEN_HEIGHT 700
+
+/* File layout: PackHeader, entryCount PackEntry records sorted by name, then
+   the pixel blobs, each PACK_ALIGN-aligned and already in the raylib pixel
+   format the GPU receives. Names are asset paths without extension, the
+   same strings LoadAsset takes. */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+} PackHeader;
+
+typedef struct
+{
+    char name[PACK_NAME_SIZE];
+    int32_t width;
+    int32_t height;
+    int32_t format;
+    int32_t mipmaps;
+    uint64_t offset;
+    uint64_t size;
+} PackEntry;
+
+typedef struct
+{
+    const PackHeader *header;
+    const PackEntry *entries;
+    uint8_t *data;
+    size_t size;
+    bool mapped;
+} AssetPack;
+
+static AssetPack assetPack;
+
+/* An entry must name itself with a terminated string and describe one
+   level of pixels that lies wholly inside the file. */
+static inline bool PackEntryValid(const PackEntry *e, size_t fileSize)
+{
+    if (!memchr(e->name, 0, PACK_NAME_SIZE) || e->mipmaps != 1 || e->width <= 0 || e->height <= 0 ||
+        e->width > PACK_MAX_DIMENSION || e->height > PACK_MAX_DIMENSION)
+        return false;
+    if (e->offset > fileSize || e->size > fileSize - e->offset)
+        return false;
+    int needed = GetPixelDataSize(e->width, e->height, e->format);
+    return needed > 0 && e->size >= (uint64_t)needed;
+}
+
+static inline bool PackOpen(const char *path)
+{
+    memset(&assetPack, 0, sizeof(assetPack));
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PackHeader))
+    {
+        close(fd);
+        return false;
+    }
+    assetPack.size = (size_t)st.st_size;
+    void *data = mmap(NULL, assetPack.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    assetPack.data = (uint8_t *)data;
+    assetPack.mapped = true;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    assetPack.size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    assetPack.data = (uint8_t *)malloc(assetPack.size);
+    if (!assetPack.data || fread(assetPack.data, 1, assetPack.size, f) != assetPack.size)
+    {
+        fclose(f);
+        free(assetPack.data);
+        memset(&assetPack, 0, sizeof(assetPack));
+        return false;
+    }
+    fclose(f);
+#endif
+
+    const PackHeader *h = (const PackHeader *)assetPack.data;
+    bool valid = memcmp(h->magic, PACK_MAGIC, 4) == 0 && h->version == PACK_VERSION &&
+                 sizeof(PackHeader) + (size_t)h->entryCount * sizeof(PackEntry) <= assetPack.size;
+    const PackEntry *entries = (const PackEntry *)(assetPack.data + sizeof(PackHeader));
+    for (uint32_t i = 0; valid && i < h->entryCount; i++)
+        valid = PackEntryValid(&entries[i], assetPack.size);
+
+    if (!valid)
+    {
+#ifndef _WIN32
+        munmap(assetPack.data, assetPack.size);
+#else
+        free(assetPack.data);
+#endif
+        memset(&assetPack, 0, sizeof(assetPack));
+        return false;
+    }
+
+    assetPack.header = h;
+    assetPack.entries = entries;
+    return true;
+}
+
+static inline void PackClose(void)
+{
+    if (!assetPack.data)
+        return;
+#ifndef _WIN32
+    munmap(assetPack.data, assetPack.size);
+#else
+    free(assetPack.data);
+#endif
+    memset(&assetPack, 0, sizeof(assetPack));
+}
+
+static inline int PackCompareName(const void *key, const void *entry)
+{
+    return strcmp((const char *)key, ((const PackEntry *)entry)->name);
+}
+
+/* Returns an Image whose pixels live inside the pack; never UnloadImage it. */
+static inline bool PackFindImage(const char *name, Image *out)
+{
+    if (!assetPack.header)
+        return false;
+    const PackEntry *e = (const PackEntry *)bsearch(name, assetPack.entries, assetPack.header->entryCount,
+                                                    sizeof(PackEntry), PackCompareName);
+    if (!e)
+        return false;
+
+    out->data = assetPack.data + e->offset;
+    out->width = e->width;
+    out->height = e->height;
+    out->format = e->format;
+    out->mipmaps = e->mipmaps;
+    return true;
+}
+
+static inline bool PackOwns(const void *pixels)
+{
+    const uint8_t *p = (const uint8_t *)pixels;
+    return assetPack.data && p >= assetPack.data && p < assetPack.data + assetPack.size;
+}
+
+/* UnloadImage for anything that may have come from the pack. */
+static inline void ReleaseAssetImage(Image image)
+{
+    if (image.data != NULL && !PackOwns(image.data))
+        UnloadImage(image);
+}
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "combat.h"
+#include "profiler.h"
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#define PARTICLE_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define PARTICLE_MAX 65536
+#define PARTICLE_CULL_MARGIN 64.0f
+
+/* How one burst looks. Particles leave a ring of the given radius around
+   the emitter, outward within [angleMin, angleMax] or, with orbit set,
+   along the ring; gravity pulls them down (negative rises) and drag slows
+   them per second. Color fades from colorA/colorB picks to transparent. */
+typedef struct
+{
+    int count;
+    float radius;
+    float angleMin;
+    float angleMax;
+    float speedMin;
+    float speedMax;
+    float lifeMin;
+    float lifeMax;
+    float sizeMin;
+    float sizeMax;
+    float gravity;
+    float drag;
+    bool orbit;
+    Color colorA;
+    Color colorB;
+} ParticleEmitter;
+
+/* Fixed-capacity pool of live particles packed in [0, count), one array per
+   field so the update loop streams through memory and vectorizes. A full
+   pool drops new particles instead of growing. */
+typedef struct
+{
+    int count;
+    float x[PARTICLE_MAX];
+    float y[PARTICLE_MAX];
+    float vx[PARTICLE_MAX];
+    float vy[PARTICLE_MAX];
+    float age[PARTICLE_MAX];
+    float life[PARTICLE_MAX];
+    float size[PARTICLE_MAX];
+    float gravity[PARTICLE_MAX];
+    float drag[PARTICLE_MAX];
+    uint32_t color[PARTICLE_MAX];
+    Rng rng;
+} ParticlePool;
+
+static inline void ParticlePoolClear(ParticlePool *pool, uint64_t seed)
+{
+    pool->count = 0;
+    RngSeed(&pool->rng, seed);
+}
+
+static inline float ParticleRandom(Rng *rng, float min, float max)
+{
+    return min + (max - min) * (float)(RngNext(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+static inline void ParticleEmit(ParticlePool *pool, const ParticleEmitter *e, float x, float y)
+{
+    Rng *rng = &pool->rng;
+    int n = e->count;
+    if (n > PARTICLE_MAX - pool->count)
+        n = PARTICLE_MAX - pool->count;
+
+    for (int k = 0; k < n; k++)
+    {
+        int i = pool->count++;
+        float angle = ParticleRandom(rng, e->angleMin, e->angleMax);
+        float speed = ParticleRandom(rng, e->speedMin, e->speedMax);
+        float c = cosf(angle), s = sinf(angle);
+        pool->x[i] = x + c * e->radius;
+        pool->y[i] = y + s * e->radius;
+        pool->vx[i] = e->orbit ? -s * speed : c * speed;
+        pool->vy[i] = e->orbit ? c * speed : s * speed;
+        pool->age[i] = 0.0f;
+        pool->life[i] = ParticleRandom(rng, e->lifeMin, e->lifeMax);
+        pool->size[i] = ParticleRandom(rng, e->sizeMin, e->sizeMax);
+        pool->gravity[i] = e->gravity;
+        pool->drag[i] = e->drag;
+        Color col = (RngNext(rng) & 1) ? e->colorA : e->colorB;
+        pool->color[i] = (uint32_t)col.r | (uint32_t)col.g << 8 | (uint32_t)col.b << 16 | (uint32_t)col.a << 24;
+    }
+}
+
+/* Moves the last particle into slot i. */
+static inline void ParticleRemove(ParticlePool *pool, int i)
+{
+    int last = --pool->count;
+    pool->x[i] = pool->x[last];
+    pool->y[i] = pool->y[last];
+    pool->vx[i] = pool->vx[last];
+    pool->vy[i] = pool->vy[last];
+    pool->age[i] = pool->age[last];
+    pool->life[i] = pool->life[last];
+    pool->size[i] = pool->size[last];
+    pool->gravity[i] = pool->gravity[last];
+    pool->drag[i] = pool->drag[last];
+    pool->color[i] = pool->color[last];
+}
+
+/* Integrates every particle four at a time with SSE2 (scalar for the tail
+   and on other targets) and flags the ones that expired or left the screen
+   in the same pass; the removal pass only runs when something died. */
+static inline void ParticleUpdate(ParticlePool *pool, float dt, float width, float height)
+{
+    int n = pool->count;
+    float *x = pool->x, *y = pool->y, *vx = pool->vx, *vy = pool->vy, *age = pool->age;
+    const float *life = pool->life, *gravity = pool->gravity, *drag = pool->drag;
+    float minX = -PARTICLE_CULL_MARGIN, maxX = width + PARTICLE_CULL_MARGIN;
+    float minY = -PARTICLE_CULL_MARGIN, maxY = height + PARTICLE_CULL_MARGIN;
+
+    int i = 0;
+    bool anyDead = false;
+#ifdef PARTICLE_HAVE_SSE2
+    __m128 step = _mm_set1_ps(dt), one = _mm_set1_ps(1.0f);
+    __m128 loX = _mm_set1_ps(minX), hiX = _mm_set1_ps(maxX), loY = _mm_set1_ps(minY), hiY = _mm_set1_ps(maxY);
+    __m128 dead = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 keep = _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(drag + i), step));
+        __m128 nvx = _mm_mul_ps(_mm_loadu_ps(vx + i), keep);
+        __m128 nvy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), keep), _mm_mul_ps(_mm_loadu_ps(gravity + i), step));
+        __m128 nx = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(nvx, step));
+        __m128 ny = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(nvy, step));
+        __m128 nage = _mm_add_ps(_mm_loadu_ps(age + i), step);
+        _mm_storeu_ps(vx + i, nvx);
+        _mm_storeu_ps(vy + i, nvy);
+        _mm_storeu_ps(x + i, nx);
+        _mm_storeu_ps(y + i, ny);
+        _mm_storeu_ps(age + i, nage);
+
+        dead = _mm_or_ps(dead, _mm_cmpge_ps(nage, _mm_loadu_ps(life + i)));
+        dead = _mm_or_ps(dead, _mm_or_ps(_mm_cmplt_ps(nx, loX), _mm_cmpgt_ps(nx, hiX)));
+        dead = _mm_or_ps(dead, _mm_or_ps(_mm_cmplt_ps(ny, loY), _mm_cmpgt_ps(ny, hiY)));
+    }
+    anyDead = _mm_movemask_ps(dead) != 0;
+#endif
+    for (; i < n; i++)
+    {
+        float keep = 1.0f - drag[i] * dt;
+        vx[i] *= keep;
+        vy[i] = vy[i] * keep + gravity[i] * dt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        age[i] += dt;
+        anyDead = anyDead || age[i] >= life[i] || x[i] < minX || x[i] > maxX || y[i] < minY || y[i] > maxY;
+    }
+    if (!anyDead)
+        return;
+
+    for (i = n - 1; i >= 0; i--)
+    {
+        if (age[i] >= life[i] || x[i] < minX || x[i] > maxX || y[i] < minY || y[i] > maxY)
+            ParticleRemove(pool, i);
+    }
+}
+
+/* One untextured quad per particle in a single rlgl batch, shrinking and
+   fading out over its life. */
+static inline void ParticleDraw(const ParticlePool *pool)
+{
+    int n = pool->count;
+    if (n == 0)
+        return;
+
+    unsigned int texture = rlGetTextureIdDefault();
+    rlSetTexture(texture);
+    rlBegin(RL_QUADS);
+    for (int i = 0; i < n; i++)
+    {
+        float t = 1.0f - pool->age[i] / pool->life[i];
+        float half = pool->size[i] * (0.5f + 0.5f * t) * 0.5f;
+        uint32_t c = pool->color[i];
+        float x0 = pool->x[i] - half, y0 = pool->y[i] - half;
+        float x1 = pool->x[i] + half, y1 = pool->y[i] + half;
+
+        PROF_COUNT_DRAW(texture);
+        rlCheckRenderBatchLimit(4);
+        rlColor4ub((unsigned char)c, (unsigned char)(c >> 8), (unsigned char)(c >> 16), (unsigned char)((c >> 24) * t));
+        rlTexCoord2f(0.0f, 0.0f);
+        rlVertex2f(x0, y0);
+        rlTexCoord2f(0.0f, 1.0f);
+        rlVertex2f(x0, y1);
+        rlTexCoord2f(1.0f, 1.0f);
+        rlVertex2f(x1, y1);
+        rlTexCoord2f(1.0f, 0.0f);
+        rlVertex2f(x1, y0);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+#endif
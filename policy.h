@@ -0,0 +1,167 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "combat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define POLICY_MAGIC "RRPT"
+#define POLICY_VERSION 1
+#define POLICY_MAX_BUILDS 16
+#define POLICY_PLAYER_HP (PLAYER_START_HP + 1)
+#define POLICY_BOSS_HP (BOSS_START_HP + 1)
+#define POLICY_STATES (POLICY_PLAYER_HP * POLICY_BOSS_HP * (1 << INVENTORY_SIZE) * 2)
+#define POLICY_VALUE_SCALE 65535.0f
+
+/* File layout: PolicyHeader, buildCount PolicyBuild entries, then one uint16
+   win-probability block and one int8 action block per build. Each block is
+   indexed by PolicyIndex, player hp varying fastest so a turn's reachable
+   states sit next to each other. */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t buildCount;
+    uint32_t playerHp;
+    uint32_t bossHp;
+    uint32_t stateCount;
+    uint32_t reserved[2];
+} PolicyHeader;
+
+typedef struct
+{
+    uint8_t inventory[INVENTORY_SIZE];
+    uint32_t reserved;
+} PolicyBuild;
+
+typedef struct
+{
+    const PolicyHeader *header;
+    const PolicyBuild *builds;
+    const uint16_t *values;
+    const int8_t *actions;
+    void *data;
+    size_t size;
+    bool mapped;
+} PolicyTable;
+
+static inline int PolicyIndex(int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    return ((int)(mask * 2 + (armor ? 1 : 0)) * POLICY_BOSS_HP + bossHp) * POLICY_PLAYER_HP + playerHp;
+}
+
+static inline int PolicyFindBuild(const PolicyTable *table, const ItemType inventory[INVENTORY_SIZE])
+{
+    for (uint32_t b = 0; b < table->header->buildCount; b++)
+    {
+        bool match = true;
+        for (int i = 0; i < INVENTORY_SIZE && match; i++)
+            match = table->builds[b].inventory[i] == (uint8_t)inventory[i];
+        if (match)
+            return (int)b;
+    }
+    return -1;
+}
+
+static inline float PolicyWinChance(const PolicyTable *table, int build, int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    size_t offset = (size_t)build * POLICY_STATES + (size_t)PolicyIndex(playerHp, bossHp, mask, armor);
+    return table->values[offset] / POLICY_VALUE_SCALE;
+}
+
+static inline int PolicyBestAction(const PolicyTable *table, int build, int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    size_t offset = (size_t)build * POLICY_STATES + (size_t)PolicyIndex(playerHp, bossHp, mask, armor);
+    return table->actions[offset];
+}
+
+static inline bool PolicyTableOpen(PolicyTable *table, const char *path)
+{
+    memset(table, 0, sizeof(*table));
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PolicyHeader))
+    {
+        close(fd);
+        return false;
+    }
+    table->size = (size_t)st.st_size;
+    table->data = mmap(NULL, table->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (table->data == MAP_FAILED)
+    {
+        table->data = NULL;
+        return false;
+    }
+    table->mapped = true;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    table->size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    table->data = malloc(table->size);
+    if (!table->data || fread(table->data, 1, table->size, f) != table->size)
+    {
+        fclose(f);
+        free(table->data);
+        table->data = NULL;
+        return false;
+    }
+    fclose(f);
+#endif
+
+    const PolicyHeader *h = (const PolicyHeader *)table->data;
+    size_t expected = sizeof(PolicyHeader) + h->buildCount * (sizeof(PolicyBuild) + (size_t)POLICY_STATES * 3);
+    if (memcmp(h->magic, POLICY_MAGIC, 4) != 0 || h->version != POLICY_VERSION ||
+        h->playerHp != POLICY_PLAYER_HP || h->bossHp != POLICY_BOSS_HP || h->stateCount != POLICY_STATES ||
+        h->buildCount > POLICY_MAX_BUILDS || table->size < expected)
+    {
+#ifndef _WIN32
+        munmap(table->data, table->size);
+#else
+        free(table->data);
+#endif
+        memset(table, 0, sizeof(*table));
+        return false;
+    }
+
+    const uint8_t *p = (const uint8_t *)table->data + sizeof(PolicyHeader);
+    table->header = h;
+    table->builds = (const PolicyBuild *)p;
+    p += h->buildCount * sizeof(PolicyBuild);
+    table->values = (const uint16_t *)p;
+    p += (size_t)h->buildCount * POLICY_STATES * sizeof(uint16_t);
+    table->actions = (const int8_t *)p;
+    return true;
+}
+
+static inline void PolicyTableClose(PolicyTable *table)
+{
+    if (!table->data)
+        return;
+#ifndef _WIN32
+    if (table->mapped)
+        munmap(table->data, table->size);
+    else
+        free(table->data);
+#else
+    free(table->data);
+#endif
+    memset(table, 0, sizeof(*table));
+}
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/* Frame profiler, built only with -DRUSH_PROFILE. Without it every PROF_*
+   macro expands to nothing and none of this code is compiled. */
+
+typedef enum
+{
+    PROF_FRAME,
+    PROF_UPDATE_TITLE,
+    PROF_UPDATE_EXPLORE,
+    PROF_UPDATE_BATTLE,
+    PROF_UPDATE_ENDING,
+    PROF_ASSETS_INIT,
+    PROF_ASSETS_STREAM,
+    PROF_WIN_ODDS,
+    PROF_HUD_LAYERS,
+    PROF_DRAW_TITLE,
+    PROF_DRAW_EXPLORE,
+    PROF_DRAW_BATTLE,
+    PROF_DRAW_ENDING,
+    PROF_PRESENT,
+    PROF_PHASE_COUNT
+} ProfPhase;
+
+#ifdef RUSH_PROFILE
+
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PROF_HISTORY 240
+#define PROF_TOGGLE_KEY KEY_F3
+
+static const char *const profPhaseNames[PROF_PHASE_COUNT] = {
+    "frame", "update_title", "update_explore", "update_battle", "update_ending", "assets_init",
+    "assets_stream", "win_odds", "hud_layers", "draw_title", "draw_explore", "draw_battle", "draw_ending", "present",
+};
+
+typedef struct
+{
+    double start[PROF_PHASE_COUNT];
+    double current[PROF_PHASE_COUNT];
+    float history[PROF_PHASE_COUNT][PROF_HISTORY];
+    int drawHistory[PROF_HISTORY];
+    int bindHistory[PROF_HISTORY];
+    int draws;
+    int binds;
+    unsigned int lastTexture;
+    long frame;
+    int head;
+    int filled;
+    bool overlay;
+    FILE *csv;
+} Profiler;
+
+static Profiler profiler;
+
+static void ProfBegin(ProfPhase phase)
+{
+    profiler.start[phase] = GetTime();
+}
+
+static void ProfEnd(ProfPhase phase)
+{
+    profiler.current[phase] += GetTime() - profiler.start[phase];
+}
+
+/* Every submission is a draw; a texture change is a bind and, in raylib's
+   batcher, the start of a new draw call. */
+static void ProfCountDraw(unsigned int textureId)
+{
+    profiler.draws++;
+    if (textureId != profiler.lastTexture)
+    {
+        profiler.binds++;
+        profiler.lastTexture = textureId;
+    }
+}
+
+static void ProfOpenCsv(const char *path)
+{
+    profiler.csv = fopen(path, "w");
+    if (!profiler.csv)
+    {
+        TraceLog(LOG_WARNING, "PROFILER: nao foi possivel criar %s", path);
+        return;
+    }
+    fprintf(profiler.csv, "frame");
+    for (int p = 0; p < PROF_PHASE_COUNT; p++)
+        fprintf(profiler.csv, ",%s_ms", profPhaseNames[p]);
+    fprintf(profiler.csv, ",draws,binds\n");
+}
+
+static void ProfCloseCsv(void)
+{
+    if (profiler.csv)
+        fclose(profiler.csv);
+    profiler.csv = NULL;
+}
+
+static void ProfFrameBegin(void)
+{
+    if (IsKeyPressed(PROF_TOGGLE_KEY))
+        profiler.overlay = !profiler.overlay;
+    ProfBegin(PROF_FRAME);
+}
+
+/* Closes the frame: stores every phase in the rolling history and the CSV. */
+static void ProfFrameEnd(void)
+{
+    ProfEnd(PROF_FRAME);
+
+    int slot = profiler.head;
+    for (int p = 0; p < PROF_PHASE_COUNT; p++)
+    {
+        profiler.history[p][slot] = (float)(profiler.current[p] * 1000.0);
+        profiler.current[p] = 0.0;
+    }
+    profiler.drawHistory[slot] = profiler.draws;
+    profiler.bindHistory[slot] = profiler.binds;
+
+    if (profiler.csv)
+    {
+        fprintf(profiler.csv, "%ld", profiler.frame);
+        for (int p = 0; p < PROF_PHASE_COUNT; p++)
+            fprintf(profiler.csv, ",%.4f", profiler.history[p][slot]);
+        fprintf(profiler.csv, ",%d,%d\n", profiler.draws, profiler.binds);
+    }
+
+    profiler.draws = 0;
+    profiler.binds = 0;
+    profiler.lastTexture = 0;
+    profiler.frame++;
+    profiler.head = (profiler.head + 1) % PROF_HISTORY;
+    if (profiler.filled < PROF_HISTORY)
+        profiler.filled++;
+}
+
+static int ProfCompareFloat(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void ProfDrawOverlay(void)
+{
+    if (!profiler.overlay || profiler.filled == 0)
+        return;
+
+    int n = profiler.filled;
+    int x = 10, y = 10;
+    DrawRectangle(x - 5, y - 5, 470, 20 + 16 * PROF_PHASE_COUNT + 100, (Color){0, 0, 0, 200});
+    DrawText("fase                 min    med    p99    max (ms)", x, y, 10, YELLOW);
+    y += 16;
+
+    for (int p = 0; p < PROF_PHASE_COUNT; p++)
+    {
+        float sorted[PROF_HISTORY];
+        memcpy(sorted, profiler.history[p], sizeof(float) * n);
+        qsort(sorted, (size_t)n, sizeof(float), ProfCompareFloat);
+        double sum = 0.0;
+        for (int i = 0; i < n; i++)
+            sum += sorted[i];
+        int p99 = (n * 99) / 100;
+        if (p99 >= n)
+            p99 = n - 1;
+        DrawText(TextFormat("%-18s %6.2f %6.2f %6.2f %6.2f", profPhaseNames[p], sorted[0], sum / n, sorted[p99], sorted[n - 1]),
+                 x, y, 10, WHITE);
+        y += 16;
+    }
+
+    int last = (profiler.head + PROF_HISTORY - 1) % PROF_HISTORY;
+    DrawText(TextFormat("draws %d   binds %d", profiler.drawHistory[last], profiler.bindHistory[last]), x, y, 10, WHITE);
+    y += 20;
+
+    const float graphMs = 33.3f;
+    const int graphHeight = 60;
+    DrawRectangleLines(x, y, PROF_HISTORY, graphHeight, GRAY);
+    DrawLine(x, y + graphHeight - (int)(graphHeight * 16.7f / graphMs), x + PROF_HISTORY,
+             y + graphHeight - (int)(graphHeight * 16.7f / graphMs), DARKGREEN);
+    for (int i = 0; i < n; i++)
+    {
+        int slot = (profiler.head + PROF_HISTORY - n + i) % PROF_HISTORY;
+        float ms = profiler.history[PROF_FRAME][slot];
+        int h = (int)(graphHeight * (ms > graphMs ? 1.0f : ms / graphMs));
+        DrawLine(x + i, y + graphHeight, x + i, y + graphHeight - h, ms > 16.7f ? RED : GREEN);
+    }
+}
+
+#define PROF_BEGIN(phase) ProfBegin(phase)
+#define PROF_END(phase) ProfEnd(phase)
+#define PROF_FRAME_BEGIN() ProfFrameBegin()
+#define PROF_FRAME_END() ProfFrameEnd()
+#define PROF_DRAW_OVERLAY() ProfDrawOverlay()
+#define PROF_OPEN_CSV(path) ProfOpenCsv(path)
+#define PROF_CLOSE_CSV() ProfCloseCsv()
+#define PROF_COUNT_DRAW(textureId) ProfCountDraw(textureId)
+#define PROF_WANTS_FRAMES() (profiler.overlay || profiler.csv != NULL)
+
+/* Everything drawn after this header goes through the counters. The overlay
+   above is defined first so it does not count itself. */
+#define DrawTexturePro(t, ...) (ProfCountDraw((t).id), DrawTexturePro(t, __VA_ARGS__))
+#define DrawTextureRec(t, ...) (ProfCountDraw((t).id), DrawTextureRec(t, __VA_ARGS__))
+#define DrawText(...) (ProfCountDraw(GetFontDefault().texture.id), DrawText(__VA_ARGS__))
+#define DrawRectangle(...) (ProfCountDraw(rlGetTextureIdDefault()), DrawRectangle(__VA_ARGS__))
+#define DrawRectangleRec(...) (ProfCountDraw(rlGetTextureIdDefault()), DrawRectangleRec(__VA_ARGS__))
+#define DrawRectangleLines(...) (ProfCountDraw(rlGetTextureIdDefault()), DrawRectangleLines(__VA_ARGS__))
+#define DrawCircle(...) (ProfCountDraw(rlGetTextureIdDefault()), DrawCircle(__VA_ARGS__))
+
+#else
+
+#define PROF_BEGIN(phase) ((void)0)
+#define PROF_END(phase) ((void)0)
+#define PROF_FRAME_BEGIN() ((void)0)
+#define PROF_FRAME_END() ((void)0)
+#define PROF_DRAW_OVERLAY() ((void)0)
+#define PROF_OPEN_CSV(path) ((void)(path))
+#define PROF_CLOSE_CSV() ((void)0)
+#define PROF_COUNT_DRAW(textureId) ((void)0)
+#define PROF_WANTS_FRAMES() false
+
+#endif
+
+#endif
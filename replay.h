@@ -0,0 +1,194 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "raylib.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "RRPL"
+#define REPLAY_VERSION 2
+#define REPLAY_FLAG_ENDLESS 1
+#define REPLAY_MAX_SPEED 100
+
+/* Every key the game loop reads. Frames are stored as the frame delta plus one
+   "down" and one "pressed" bit per key, 6 bytes per frame. */
+static const int replayKeys[] = {KEY_RIGHT, KEY_D, KEY_LEFT, KEY_A, KEY_ENTER};
+#define REPLAY_KEY_COUNT ((int)(sizeof(replayKeys) / sizeof(replayKeys[0])))
+
+typedef enum
+{
+    REPLAY_OFF,
+    REPLAY_RECORDING,
+    REPLAY_PLAYING,
+    REPLAY_SCRIPTED
+} ReplayMode;
+
+typedef struct
+{
+    float delta;
+    uint8_t down;
+    uint8_t pressed;
+} InputFrame;
+
+static ReplayMode replayMode = REPLAY_OFF;
+static FILE *replayFile = NULL;
+static InputFrame currentInput;
+static InputFrame scriptedInput;
+static uint8_t pendingPressed = 0;
+static long replayFrameCount = 0;
+
+static int ReplayKeyIndex(int key)
+{
+    for (int i = 0; i < REPLAY_KEY_COUNT; i++)
+    {
+        if (replayKeys[i] == key)
+            return i;
+    }
+    return -1;
+}
+
+/* Version 2 adds a flags byte after the version; version 1 files still
+   play back with no flags set. */
+static bool ReplayStartRecording(const char *path, uint64_t seed, uint8_t flags)
+{
+    replayFile = fopen(path, "wb");
+    if (!replayFile)
+        return false;
+
+    uint8_t version = REPLAY_VERSION;
+    fwrite(REPLAY_MAGIC, 1, 4, replayFile);
+    fwrite(&version, 1, 1, replayFile);
+    fwrite(&flags, 1, 1, replayFile);
+    fwrite(&seed, sizeof(seed), 1, replayFile);
+    replayMode = REPLAY_RECORDING;
+    replayFrameCount = 0;
+    return true;
+}
+
+static bool ReplayStartPlayback(const char *path, uint64_t *seed, uint8_t *flags)
+{
+    replayFile = fopen(path, "rb");
+    if (!replayFile)
+        return false;
+
+    char magic[4];
+    uint8_t version = 0;
+    *flags = 0;
+    if (fread(magic, 1, 4, replayFile) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+        fread(&version, 1, 1, replayFile) != 1 || version < 1 || version > REPLAY_VERSION ||
+        (version >= 2 && fread(flags, 1, 1, replayFile) != 1) || fread(seed, sizeof(*seed), 1, replayFile) != 1)
+    {
+        fclose(replayFile);
+        replayFile = NULL;
+        return false;
+    }
+    replayMode = REPLAY_PLAYING;
+    replayFrameCount = 0;
+    return true;
+}
+
+static void ReplayStop(void)
+{
+    if (replayFile)
+        fclose(replayFile);
+    replayFile = NULL;
+    replayMode = REPLAY_OFF;
+}
+
+static inline uint8_t ReplayKeyBit(int key)
+{
+    int i = ReplayKeyIndex(key);
+    return i >= 0 ? (uint8_t)(1u << i) : 0;
+}
+
+/* Feeds the next simulation step from code instead of the keyboard. */
+static inline void ReplayScriptInput(uint8_t down, uint8_t pressed)
+{
+    replayMode = REPLAY_SCRIPTED;
+    scriptedInput.down = down;
+    scriptedInput.pressed = pressed;
+}
+
+static bool ReplayIsPlaying(void)
+{
+    return replayMode == REPLAY_PLAYING;
+}
+
+static inline bool ReplayIsActive(void)
+{
+    return replayMode == REPLAY_RECORDING || replayMode == REPLAY_PLAYING;
+}
+
+/* Latches key presses once per rendered frame, so a press is seen by exactly
+   one simulation step even when a frame runs zero or several steps. */
+static void ReplayPollInput(void)
+{
+    for (int i = 0; i < REPLAY_KEY_COUNT; i++)
+    {
+        if (IsKeyPressed(replayKeys[i]))
+            pendingPressed |= (uint8_t)(1u << i);
+    }
+}
+
+/* Samples the live input (or the next recorded frame) once per simulation step.
+   The Update* functions only see input through this frame. */
+static void ReplayBeginFrame(float delta)
+{
+    if (replayMode == REPLAY_SCRIPTED)
+    {
+        currentInput = scriptedInput;
+        currentInput.delta = delta;
+        return;
+    }
+    if (replayMode == REPLAY_PLAYING)
+    {
+        if (fread(&currentInput.delta, sizeof(float), 1, replayFile) == 1 &&
+            fread(&currentInput.down, 1, 1, replayFile) == 1 &&
+            fread(&currentInput.pressed, 1, 1, replayFile) == 1)
+        {
+            replayFrameCount++;
+            return;
+        }
+        TraceLog(LOG_INFO, "REPLAY: fim da gravacao apos %ld frames", replayFrameCount);
+        ReplayStop();
+    }
+
+    currentInput.delta = delta;
+    currentInput.down = 0;
+    currentInput.pressed = pendingPressed;
+    pendingPressed = 0;
+    for (int i = 0; i < REPLAY_KEY_COUNT; i++)
+    {
+        if (IsKeyDown(replayKeys[i]))
+            currentInput.down |= (uint8_t)(1u << i);
+    }
+
+    if (replayMode == REPLAY_RECORDING)
+    {
+        fwrite(&currentInput.delta, sizeof(float), 1, replayFile);
+        fwrite(&currentInput.down, 1, 1, replayFile);
+        fwrite(&currentInput.pressed, 1, 1, replayFile);
+        replayFrameCount++;
+    }
+}
+
+static bool InputKeyDown(int key)
+{
+    int i = ReplayKeyIndex(key);
+    return i >= 0 && (currentInput.down & (1u << i));
+}
+
+static bool InputKeyPressed(int key)
+{
+    int i = ReplayKeyIndex(key);
+    return i >= 0 && (currentInput.pressed & (1u << i));
+}
+
+static float InputFrameTime(void)
+{
+    return currentInput.delta;
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef RESSCALE_H
+#define RESSCALE_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define RESSCALE_MIN 0.5f
+#define RESSCALE_MAX 1.0f
+#define RESSCALE_STEP 0.05f
+#define RESSCALE_HIGH 0.95f
+#define RESSCALE_LOW 0.70f
+#define RESSCALE_DOWN_FRAMES 10
+#define RESSCALE_UP_FRAMES 90
+#define RESSCALE_COOLDOWN_FRAMES 30
+#define RESSCALE_SMOOTHING 0.1f
+#define RESSCALE_SHARPEN_MAX 0.6f
+#define RESSCALE_QUERIES 4
+
+/* GPU time comes from timer queries where the Linux build can reach them:
+   they are core in OpenGL 3.3 and exported by the libGL it links. Elsewhere
+   the controller falls back to the CPU time spent submitting the frame. */
+#if defined(__linux__) && !defined(RESSCALE_NO_GPU_TIMER)
+#define RESSCALE_GPU_TIMER 1
+#define RESSCALE_GL_TIME_ELAPSED 0x88BF
+#define RESSCALE_GL_QUERY_RESULT 0x8866
+#define RESSCALE_GL_QUERY_RESULT_AVAILABLE 0x8867
+void glGenQueries(int n, unsigned int *ids);
+void glDeleteQueries(int n, const unsigned int *ids);
+void glBeginQuery(unsigned int target, unsigned int id);
+void glEndQuery(unsigned int target);
+void glGetQueryObjectiv(unsigned int id, unsigned int pname, int *params);
+void glGetQueryObjectui64v(unsigned int id, unsigned int pname, uint64_t *params);
+#endif
+
+/* Clamped unsharp mask: pushes each pixel away from its four neighbours'
+   average, but never past their range, so edges sharpen without halos. */
+static const char *const resScaleSharpenFs =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "uniform vec2 texel;\n"
+    "uniform float amount;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec3 c = texture(texture0, fragTexCoord).rgb;\n"
+    "    vec3 n = texture(texture0, fragTexCoord - vec2(0.0, texel.y)).rgb;\n"
+    "    vec3 s = texture(texture0, fragTexCoord + vec2(0.0, texel.y)).rgb;\n"
+    "    vec3 w = texture(texture0, fragTexCoord - vec2(texel.x, 0.0)).rgb;\n"
+    "    vec3 e = texture(texture0, fragTexCoord + vec2(texel.x, 0.0)).rgb;\n"
+    "    vec3 lo = min(c, min(min(n, s), min(w, e)));\n"
+    "    vec3 hi = max(c, max(max(n, s), max(w, e)));\n"
+    "    vec3 sharp = clamp(c + amount * (4.0 * c - n - s - w - e), lo, hi);\n"
+    "    finalColor = vec4(sharp, 1.0) * fragColor * colDiffuse;\n"
+    "}\n";
+
+/* Dynamic resolution: the scene is drawn in logical coordinates into a
+   render texture sized scale times the window's letterboxed viewport, then
+   upscaled with the sharpening pass; the HUD goes on top at the window's
+   own resolution. The scale moves in RESSCALE_STEP steps: down when the
+   smoothed GPU time stays above RESSCALE_HIGH of the budget, up only after
+   a long run below RESSCALE_LOW, and never twice within the cooldown, so it
+   settles instead of flickering between two sizes. */
+typedef struct
+{
+    int logicalWidth;
+    int logicalHeight;
+    RenderTexture2D target;
+    Rectangle viewport;
+    float outputScale;
+    float scale;
+    bool fixed;
+    float budgetMs;
+    float gpuMs;
+    bool hasSample;
+    int overFrames;
+    int underFrames;
+    int cooldown;
+    int changes;
+
+    Shader sharpen;
+    int texelLoc;
+    int amountLoc;
+
+    bool gpuTimer;
+    unsigned int queries[RESSCALE_QUERIES];
+    bool queryPending[RESSCALE_QUERIES];
+    int queryNext;
+    bool queryActive;
+    double cpuStart;
+} ResScale;
+
+static inline void ResScaleInit(ResScale *rs, int logicalWidth, int logicalHeight, float budgetMs)
+{
+    memset(rs, 0, sizeof(*rs));
+    rs->logicalWidth = logicalWidth;
+    rs->logicalHeight = logicalHeight;
+    rs->scale = RESSCALE_MAX;
+    rs->budgetMs = budgetMs;
+    rs->sharpen = LoadShaderFromMemory(NULL, resScaleSharpenFs);
+    rs->texelLoc = GetShaderLocation(rs->sharpen, "texel");
+    rs->amountLoc = GetShaderLocation(rs->sharpen, "amount");
+#ifdef RESSCALE_GPU_TIMER
+    if (rlGetVersion() == RL_OPENGL_33 || rlGetVersion() == RL_OPENGL_43)
+    {
+        glGenQueries(RESSCALE_QUERIES, rs->queries);
+        rs->gpuTimer = true;
+    }
+#endif
+}
+
+/* Pins the scale; the controller then only measures. */
+static inline void ResScaleFix(ResScale *rs, float scale)
+{
+    rs->scale = scale < RESSCALE_MIN ? RESSCALE_MIN : (scale > RESSCALE_MAX ? RESSCALE_MAX : scale);
+    rs->fixed = true;
+}
+
+/* Output pixels per logical pixel, for anything drawn at native resolution. */
+static inline float ResScaleOutput(const ResScale *rs)
+{
+    return rs->outputScale > 0.0f ? rs->outputScale : 1.0f;
+}
+
+static inline void ResScaleCollect(ResScale *rs, float ms)
+{
+    rs->gpuMs = rs->hasSample ? rs->gpuMs + (ms - rs->gpuMs) * RESSCALE_SMOOTHING : ms;
+    rs->hasSample = true;
+}
+
+/* Fits the logical screen into the window and starts timing the frame's
+   GPU work; call before anything is rendered, cached HUD layers included. */
+static inline void ResScaleFrameBegin(ResScale *rs)
+{
+    rs->cpuStart = GetTime();
+    float sw = (float)GetScreenWidth(), sh = (float)GetScreenHeight();
+    float out = fminf(sw / rs->logicalWidth, sh / rs->logicalHeight);
+    if (out <= 0.0f)
+        out = 1.0f;
+    rs->outputScale = out;
+    rs->viewport = (Rectangle){floorf((sw - rs->logicalWidth * out) / 2.0f), floorf((sh - rs->logicalHeight * out) / 2.0f),
+                               rs->logicalWidth * out, rs->logicalHeight * out};
+#ifdef RESSCALE_GPU_TIMER
+    if (!rs->gpuTimer)
+        return;
+    for (int i = 0; i < RESSCALE_QUERIES; i++)
+    {
+        if (!rs->queryPending[i])
+            continue;
+        int available = 0;
+        glGetQueryObjectiv(rs->queries[i], RESSCALE_GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        uint64_t ns = 0;
+        glGetQueryObjectui64v(rs->queries[i], RESSCALE_GL_QUERY_RESULT, &ns);
+        rs->queryPending[i] = false;
+        ResScaleCollect(rs, (float)(ns / 1.0e6));
+    }
+
+    /* A slot whose result has not arrived is skipped rather than waited on. */
+    rs->queryActive = !rs->queryPending[rs->queryNext];
+    if (rs->queryActive)
+    {
+        rlDrawRenderBatchActive();
+        glBeginQuery(RESSCALE_GL_TIME_ELAPSED, rs->queries[rs->queryNext]);
+    }
+#endif
+}
+
+/* Resizes the scene texture when the scale or the window changed and
+   starts drawing into it in logical coordinates. */
+static inline void ResScaleBeginScene(ResScale *rs)
+{
+    int w = (int)lroundf(rs->viewport.width * rs->scale), h = (int)lroundf(rs->viewport.height * rs->scale);
+    w = w < 1 ? 1 : w;
+    h = h < 1 ? 1 : h;
+    if (rs->target.id == 0 || rs->target.texture.width != w || rs->target.texture.height != h)
+    {
+        if (rs->target.id)
+            UnloadRenderTexture(rs->target);
+        rs->target = LoadRenderTexture(w, h);
+        SetTextureFilter(rs->target.texture, TEXTURE_FILTER_BILINEAR);
+    }
+
+    BeginTextureMode(rs->target);
+    rlPushMatrix();
+    rlScalef((float)w / rs->logicalWidth, (float)h / rs->logicalHeight, 1.0f);
+}
+
+static inline void ResScaleEndScene(void)
+{
+    rlPopMatrix();
+    EndTextureMode();
+}
+
+/* Inside BeginDrawing: letterboxes, upscales the scene and leaves a
+   transform that maps logical coordinates to window pixels for the HUD. */
+static inline void ResScaleBeginHud(ResScale *rs)
+{
+    ClearBackground(BLACK);
+    Texture2D t = rs->target.texture;
+    float upscale = rs->viewport.width / (float)t.width;
+    float amount = (upscale - 1.0f) * 0.5f;
+    amount = amount < 0.0f ? 0.0f : (amount > RESSCALE_SHARPEN_MAX ? RESSCALE_SHARPEN_MAX : amount);
+
+    Rectangle src = {0, 0, (float)t.width, -(float)t.height};
+    if (amount > 0.0f)
+    {
+        float texel[2] = {1.0f / t.width, 1.0f / t.height};
+        SetShaderValue(rs->sharpen, rs->texelLoc, texel, SHADER_UNIFORM_VEC2);
+        SetShaderValue(rs->sharpen, rs->amountLoc, &amount, SHADER_UNIFORM_FLOAT);
+        BeginShaderMode(rs->sharpen);
+        DrawTexturePro(t, src, rs->viewport, (Vector2){0, 0}, 0.0f, WHITE);
+        EndShaderMode();
+    }
+    else
+    {
+        DrawTexturePro(t, src, rs->viewport, (Vector2){0, 0}, 0.0f, WHITE);
+    }
+
+    rlPushMatrix();
+    rlTranslatef(rs->viewport.x, rs->viewport.y, 0.0f);
+    rlScalef(rs->outputScale, rs->outputScale, 1.0f);
+}
+
+static inline void ResScaleEndHud(void)
+{
+    rlPopMatrix();
+}
+
+static inline void ResScaleAdjust(ResScale *rs)
+{
+    if (rs->fixed || !rs->hasSample || rs->budgetMs <= 0.0f)
+        return;
+    if (rs->cooldown > 0)
+    {
+        rs->cooldown--;
+        return;
+    }
+
+    rs->overFrames = rs->gpuMs > rs->budgetMs * RESSCALE_HIGH ? rs->overFrames + 1 : 0;
+    rs->underFrames = rs->gpuMs < rs->budgetMs * RESSCALE_LOW ? rs->underFrames + 1 : 0;
+
+    float next = rs->scale;
+    if (rs->overFrames >= RESSCALE_DOWN_FRAMES && rs->scale > RESSCALE_MIN)
+    {
+        /* Fill cost follows the pixel count, the square of the scale. */
+        float wanted = rs->scale * sqrtf(rs->budgetMs * (RESSCALE_HIGH + RESSCALE_LOW) / 2.0f / rs->gpuMs);
+        next = floorf(wanted / RESSCALE_STEP) * RESSCALE_STEP;
+        if (next > rs->scale - RESSCALE_STEP)
+            next = rs->scale - RESSCALE_STEP;
+    }
+    else if (rs->underFrames >= RESSCALE_UP_FRAMES && rs->scale < RESSCALE_MAX)
+    {
+        next = rs->scale + RESSCALE_STEP;
+    }
+    next = next < RESSCALE_MIN ? RESSCALE_MIN : (next > RESSCALE_MAX ? RESSCALE_MAX : next);
+    if (fabsf(next - rs->scale) < RESSCALE_STEP / 2.0f)
+        return;
+
+    TraceLog(LOG_INFO, "RESSCALE: escala %.2f -> %.2f (GPU %.2f ms, alvo %.2f ms)", rs->scale, next, rs->gpuMs, rs->budgetMs);
+    rs->scale = next;
+    rs->overFrames = rs->underFrames = 0;
+    rs->cooldown = RESSCALE_COOLDOWN_FRAMES;
+    rs->changes++;
+}
+
+/* Closes the timed section; call right before EndDrawing. */
+static inline void ResScaleFrameEnd(ResScale *rs)
+{
+    rlDrawRenderBatchActive();
+#ifdef RESSCALE_GPU_TIMER
+    if (rs->queryActive)
+    {
+        glEndQuery(RESSCALE_GL_TIME_ELAPSED);
+        rs->queryPending[rs->queryNext] = true;
+        rs->queryNext = (rs->queryNext + 1) % RESSCALE_QUERIES;
+        rs->queryActive = false;
+    }
+#endif
+    if (!rs->gpuTimer)
+        ResScaleCollect(rs, (float)((GetTime() - rs->cpuStart) * 1000.0));
+    ResScaleAdjust(rs);
+}
+
+static inline void ResScaleUnload(ResScale *rs)
+{
+    if (rs->target.id)
+        UnloadRenderTexture(rs->target);
+    if (rs->sharpen.id)
+        UnloadShader(rs->sharpen);
+#ifdef RESSCALE_GPU_TIMER
+    if (rs->gpuTimer)
+        glDeleteQueries(RESSCALE_QUERIES, rs->queries);
+#endif
+    memset(rs, 0, sizeof(*rs));
+}
+
+#endif
@@ -1,13 +1,48 @@
 #include "raylib.h"
+#include "profiler.h"
+#include "combat.h"
+#include "replay.h"
+#include "pack.h"
+#include "atlas.h"
+#include "stream.h"
+#include "texmgr.h"
+#include "layers.h"
+#include "entity.h"
+#include "spritebatch.h"
+#include "particles.h"
+#include "battlelog.h"
+#include "idle.h"
+#include "savestate.h"
+#include "spectate.h"
+#include "odds.h"
+#include "stagegen.h"
+#include "resscale.h"
+#ifdef RUSH_BENCH
+#include "bench.h"
+#endif
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include <time.h>
 
-#define SCREEN_WIDTH 1000
-#define SCREEN_HEIGHT 700
-#define INVENTORY_SIZE 4
+#define SCREEN_WIDTH PACK_SCREEN_WIDTH
+#define SCREEN_HEIGHT PACK_SCREEN_HEIGHT
+#define STREAM_UPLOAD_BUDGET 0.002
+#define SIM_DEFAULT_HZ 120
+#define SIM_MAX_FRAME_TIME 0.25
+#define SPRITE_LAYER_ACTOR 0
+#define SPRITE_LAYER_EFFECT 1
+#define STRESS_DEFAULT_COUNT 50000
+#define PARTICLE_STRESS_DEFAULT_COUNT 50000
+#define BATTLE_GROUND_Y 480.0f
+#define BATTLE_PLAYER_X 250.0f
+#define BATTLE_BOSS_X (SCREEN_WIDTH - 250.0f)
+#define TITLE_BLINK_RATE 2
+#define WIN_ODDS_BUDGET 0.001
+#define BATTLE_LOG_VISIBLE 6
+#define BATTLE_LOG_LINE_HEIGHT 18
 
 typedef enum
 {
@@ -19,91 +54,108 @@ typedef enum
     GAME_STATE_ENDING_ESCAPE
 } GameState;
 
-typedef enum
-{
-    ITEM_NONE,
-    ITEM_POTION,
-    ITEM_SWORD,
-    ITEM_BOMB,
-    ITEM_COIN,
-    ITEM_ARMOR
-} ItemType;
-
 typedef enum
 {
     BATTLE_PLAYER_TURN,
     BATTLE_BOSS_TURN
 } BattleState;
 
+/* What the renderer interpolates between two simulation steps. */
 typedef struct
 {
-    int hp;
-    int maxHp;
-} Player;
+    float explorePlayerX;
+    float playerAttackOffset;
+    float bossAttackOffset;
+} RenderSnapshot;
 
-typedef struct
+typedef enum
 {
-    int hp;
-    int maxHp;
-    int attack;
-} Boss;
+    CLIP_PLAYER_ATTACK,
+    CLIP_BOSS_ATTACK,
+    CLIP_PLAYER_HURT,
+    CLIP_BOSS_HURT,
+    CLIP_COUNT
+} ClipId;
+
+/* Battle animations. Attack lunges and hit flashes are tracks of the clips;
+   a frame count of 0 cuts the strip into square frames. */
+static const AnimClipDef clipDefs[CLIP_COUNT] = {
+    [CLIP_PLAYER_ATTACK] = {SPRITE_PLAYER_ATTACK, 0, 0.45f, NULL, ANIM_ONE_SHOT,
+                            {[ANIM_TRACK_OFFSET_X] = {ANIM_CURVE_ARC, 450.0f - BATTLE_PLAYER_X, 0.0f}}},
+    [CLIP_BOSS_ATTACK] = {SPRITE_BOSS_ATTACK, 0, 0.40f, NULL, ANIM_ONE_SHOT,
+                          {[ANIM_TRACK_OFFSET_X] = {ANIM_CURVE_ARC, -(BATTLE_BOSS_X - 550.0f), 0.0f}}},
+    [CLIP_PLAYER_HURT] = {SPRITE_PLAYER_HIT, 1, 0.9f, NULL, ANIM_ONE_SHOT,
+                          {[ANIM_TRACK_ALPHA] = {ANIM_CURVE_BLINK, 0.5f, 30.0f}}},
+    [CLIP_BOSS_HURT] = {SPRITE_BOSS_HIT, 1, 0.9f, NULL, ANIM_ONE_SHOT,
+                        {[ANIM_TRACK_ALPHA] = {ANIM_CURVE_BLINK, 0.5f, 30.0f}}},
+};
+
+static AnimClip clips[CLIP_COUNT];
+
+static const ParticleEmitter sparkEmitter = {
+    .count = 48, .radius = 10.0f, .angleMin = -3.14f, .angleMax = 3.14f, .speedMin = 120.0f, .speedMax = 420.0f,
+    .lifeMin = 0.25f, .lifeMax = 0.6f, .sizeMin = 3.0f, .sizeMax = 6.0f, .gravity = 600.0f, .drag = 2.0f,
+    .colorA = {255, 230, 120, 255}, .colorB = {255, 150, 40, 255},
+};
+static const ParticleEmitter bombEmitter = {
+    .count = 700, .radius = 20.0f, .angleMin = -3.14f, .angleMax = 3.14f, .speedMin = 80.0f, .speedMax = 650.0f,
+    .lifeMin = 0.5f, .lifeMax = 1.3f, .sizeMin = 4.0f, .sizeMax = 12.0f, .gravity = 300.0f, .drag = 2.5f,
+    .colorA = {255, 120, 30, 255}, .colorB = {140, 140, 140, 255},
+};
+static const ParticleEmitter healEmitter = {
+    .count = 180, .radius = 50.0f, .angleMin = -3.14f, .angleMax = 3.14f, .speedMin = 60.0f, .speedMax = 120.0f,
+    .lifeMin = 0.8f, .lifeMax = 1.4f, .sizeMin = 3.0f, .sizeMax = 7.0f, .gravity = -220.0f, .drag = 0.5f, .orbit = true,
+    .colorA = {100, 255, 150, 255}, .colorB = {210, 255, 225, 255},
+};
+
+static ParticlePool battleParticles;
 
 static GameState currentState;
 static BattleState battleState;
 
-static Player player;
-static Boss boss;
+static EntityStore battleEntities;
+static int playerEntity;
+static int bossEntity;
 
 static ItemType inventory[INVENTORY_SIZE];
 static bool itemUsed[INVENTORY_SIZE];
 static int inventoryCount;
 static int selectedItemIndex;
 static int currentStage;
+static bool endlessMode;
 
-static const char *battleMessage;
-static char messageBuffer[256];
+static BattleLog battleLog;
+static int battleLogScroll;
+static uint32_t battleLogSeen;
+static const char *battleLogPath = BATTLE_LOG_DEFAULT_PATH;
+static bool battleLogExported;
 static float itemMessageTimer = 0.0f;
 static ItemType lastItemCollected = ITEM_NONE;
 
+static uint64_t gameSeed;
+static Rng combatRng;
+
 static bool playerHasArmor;
 static float bossTurnTimer;
-static float playerAttackTimer;
-static const float PLAYER_ATTACK_DURATION = 0.45f;
-static bool playerIsAttacking;
-static float playerHurtTimer;
-static const float PLAYER_HURT_DURATION = 0.9f;
-
-static bool bossIsAttacking;
-static float bossAttackTimer;
-static const float BOSS_ATTACK_DURATION = 0.40f;
-static float bossHurtTimer;
-static const float BOSS_HURT_DURATION = 0.9f;
-
-static Texture2D playerTexture;
-static Texture2D bossTexture;
+
 static Texture2D titleBackgroundTexture;
 static Texture2D battleBackgroundTexture;
-static Texture2D playerAttackTexture;
-static Texture2D bossAttackTexture;
-static Texture2D playerHitTexture;
-static Texture2D bossHitTexture;
 
 static Texture2D bgStage1;
 static Texture2D bgStage2;
 static Texture2D bgStage3;
 static Texture2D bgStage4;
+static Texture2D endlessBackground;
+static int endlessBackgroundStage = -1;
+static StageContent endlessContent;
 
 static bool texturesInitialized = false;
-
-static int playerAttackFrameCount;
-static int playerAttackFrame;
-static float playerAttackFrameTime;
-static float playerAttackFrameDuration;
-
-static int bossAttackFrameCount;
-static int bossAttackFrame;
-static float bossAttackFrameTime;
-static float bossAttackFrameDuration;
+static bool spritesReady = false;
+static int stageAssetHandles[STAGE_COUNT];
+static bool stageAssetHeld[STAGE_COUNT];
+static int battleBackgroundHandle;
+static bool battleBackgroundHeld;
+static int spriteAssetHandles[SPRITE_COUNT];
 
 static float explorePlayerX;
 static float explorePlayerY;
@@ -111,6 +163,29 @@ static Rectangle doorLeftRect;
 static Rectangle doorRightRect;
 static float explorePlayerSpeed;
 
+static Layer exploreStoryLayer;
+static Layer exploreDoorLayers[2];
+static Layer exploreHintLayer;
+static Layer itemMessageLayer;
+static Layer battleBarsLayer;
+static Layer battleItemsLayer;
+static Layer battleTextLayer;
+static Layer battleLogLayer;
+
+static float simStep = 1.0f / SIM_DEFAULT_HZ;
+static RenderSnapshot renderPrev;
+static float renderAlpha = 1.0f;
+
+static SpectatePublisher spectatePublisher;
+
+static ResScale resScale;
+static bool resScaleStatsVisible;
+
+static OddsTable winOdds;
+static bool winOddsReady;
+static float winChance;
+static int winAction;
+
 const char *GetItemName(ItemType item)
 {
     switch (item)
@@ -130,57 +205,40 @@ const char *GetItemName(ItemType item)
     }
 }
 
-ItemType GetItemForChoice(int stage, int choice)
+int PlayerSlot(void)
 {
-    if (stage == 0)
-        return ITEM_POTION;
-    if (stage == 1)
-        return (choice == 0) ? ITEM_SWORD : ITEM_BOMB;
-    if (stage == 2)
-        return (choice == 0) ? ITEM_ARMOR : ITEM_COIN;
-    return ITEM_POTION;
+    return EntityIndex(&battleEntities, playerEntity);
 }
 
-void BossAttack()
+int BossSlot(void)
 {
-    bossIsAttacking = true;
-    bossAttackTimer = BOSS_ATTACK_DURATION;
-    bossAttackFrame = 0;
-    bossAttackFrameTime = 0.0f;
-
-    if (bossAttackFrameCount > 0)
-        bossAttackFrameDuration = BOSS_ATTACK_DURATION / (float)bossAttackFrameCount;
-
-    int min = boss.attack - 5;
-    int max = boss.attack + 5;
-
-    if (playerHasArmor)
-    {
-        min = (boss.attack - 5) / 2;
-        max = (boss.attack + 5) / 2;
-    }
-    if (min < 1)
-        min = 1;
-
-    int damage = min + (rand() % (max - min + 1));
-    player.hp -= damage;
-    if (player.hp < 0)
-        player.hp = 0;
-
-    if (playerHasArmor)
-        sprintf(messageBuffer, "Chefe ataca com armadura ativa! Voce levou %d de dano.", damage);
-    else
-        sprintf(messageBuffer, "Chefe ataca! Voce levou %d de dano!", damage);
+    return EntityIndex(&battleEntities, bossEntity);
+}
 
-    battleMessage = messageBuffer;
-    playerHurtTimer = PLAYER_HURT_DURATION;
+void BossAttack()
+{
+    EntityStore *e = &battleEntities;
+    int p = PlayerSlot(), b = BossSlot();
+    EntityStartAttack(e, b);
+
+    int damage = CombatRollBossDamage(&combatRng, e->attack[b], playerHasArmor);
+    e->hp[p] -= damage;
+    if (e->hp[p] < 0)
+        e->hp[p] = 0;
+
+    BattleLogPush(&battleLog, BATTLE_LOG_BOSS, playerHasArmor ? BATTLE_LOG_BOSS_ATTACK_ARMOR : BATTLE_LOG_BOSS_ATTACK, damage);
+    battleLog.turn++;
+    EntityHurt(e, p);
 }
 
 void UseItem(int index)
 {
+    EntityStore *e = &battleEntities;
+    int p = PlayerSlot(), b = BossSlot();
+
     if (itemUsed[index])
     {
-        battleMessage = "Este item ja foi usado!";
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_ITEM_SPENT, 0);
         return;
     }
 
@@ -188,50 +246,51 @@ void UseItem(int index)
     switch (item)
     {
     case ITEM_POTION:
-        player.hp += 50;
-        if (player.hp > player.maxHp)
-            player.hp = player.maxHp;
-        battleMessage = "Voce usou Pocao! Curou 50 HP!";
+        e->hp[p] += POTION_HEAL;
+        if (e->hp[p] > e->maxHp[p])
+            e->hp[p] = e->maxHp[p];
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_POTION, POTION_HEAL);
         itemUsed[index] = true;
+        ParticleEmit(&battleParticles, &healEmitter, BATTLE_PLAYER_X, BATTLE_GROUND_Y - 30.0f);
         break;
     case ITEM_SWORD:
-        battleMessage = "Espada: aumenta seu dano. Use ATACAR [A].";
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_SWORD_HINT, 0);
         return;
     case ITEM_BOMB:
     {
-        int dmg = 60 + (rand() % 31);
-        boss.hp -= dmg;
-        sprintf(messageBuffer, "Voce usou Bomba! Causou %d de dano!", dmg);
-        battleMessage = messageBuffer;
+        int dmg = CombatRollBombDamage(&combatRng);
+        e->hp[b] -= dmg;
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_BOMB, dmg);
+        ParticleEmit(&battleParticles, &bombEmitter, BATTLE_BOSS_X, BATTLE_GROUND_Y - 40.0f);
         itemUsed[index] = true;
         break;
     }
     case ITEM_COIN:
         itemUsed[index] = true;
-        if (rand() % 2 == 0)
+        if (CombatRollCoinEscape(&combatRng))
         {
-            battleMessage = "Voce usou Moeda! Distraiu o chefe e fugiu!";
+            BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_COIN_ESCAPE, 0);
             currentState = GAME_STATE_ENDING_ESCAPE;
             return;
         }
         else
         {
-            battleMessage = "Voce usou Moeda! Mas o chefe nao se distraiu...";
+            BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_COIN_FAIL, 0);
             battleState = BATTLE_BOSS_TURN;
             bossTurnTimer = 1.5f;
             return;
         }
     case ITEM_ARMOR:
         playerHasArmor = true;
-        battleMessage = "Voce equipou Armadura! Proximos ataques causarao menos dano.";
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_ARMOR, 0);
         break;
     default:
-        battleMessage = "Item invalido?";
+        BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, BATTLE_LOG_ITEM_INVALID, 0);
         break;
     }
 
-    if (boss.hp < 0)
-        boss.hp = 0;
+    if (e->hp[b] < 0)
+        e->hp[b] = 0;
     battleState = BATTLE_BOSS_TURN;
     bossTurnTimer = 1.5f;
 }
@@ -248,27 +307,18 @@ bool PlayerHasSword(void)
 
 void PlayerAttack(void)
 {
-    int damage;
-    if (PlayerHasSword())
-    {
-        damage = 20 + (rand() % 21);
-        sprintf(messageBuffer, "Voce atacou com a espada! Causou %d de dano!", damage);
-    }
-    else
-    {
-        damage = 15 + (rand() % 8);
-        sprintf(messageBuffer, "Voce atacou desarmado! Causou %d de dano!", damage);
-    }
-    boss.hp -= damage;
-    if (boss.hp < 0)
-        boss.hp = 0;
-    battleMessage = messageBuffer;
-
-    playerIsAttacking = true;
-    playerAttackTimer = PLAYER_ATTACK_DURATION;
-    playerAttackFrame = 0;
-    playerAttackFrameTime = 0.0f;
-    bossHurtTimer = BOSS_HURT_DURATION;
+    EntityStore *e = &battleEntities;
+    int p = PlayerSlot(), b = BossSlot();
+    bool sword = PlayerHasSword();
+    int damage = CombatRollPlayerDamage(&combatRng, sword);
+    BattleLogPush(&battleLog, BATTLE_LOG_PLAYER, sword ? BATTLE_LOG_ATTACK_SWORD : BATTLE_LOG_ATTACK_UNARMED, damage);
+    e->hp[b] -= damage;
+    if (e->hp[b] < 0)
+        e->hp[b] = 0;
+
+    EntityStartAttack(e, p);
+    EntityHurt(e, b);
+    ParticleEmit(&battleParticles, &sparkEmitter, BATTLE_BOSS_X, BATTLE_GROUND_Y - 40.0f);
 
     battleState = BATTLE_BOSS_TURN;
     bossTurnTimer = 1.1f;
@@ -276,6 +326,10 @@ void PlayerAttack(void)
 
 Texture2D LoadAsset(const char *baseName)
 {
+    Image packed;
+    if (PackFindImage(baseName, &packed))
+        return LoadTextureFromImage(packed);
+
     char path[128];
     sprintf(path, "assets/%s.png", baseName);
     if (FileExists(path))
@@ -292,6 +346,40 @@ Texture2D LoadAsset(const char *baseName)
     return (Texture2D){0};
 }
 
+Image LoadAssetImage(const char *baseName)
+{
+    Image packed;
+    if (PackFindImage(baseName, &packed))
+        return packed;
+
+    char path[128];
+    sprintf(path, "assets/%s.png", baseName);
+    if (FileExists(path))
+        return LoadImage(path);
+
+    sprintf(path, "assets/%s.jpg", baseName);
+    if (FileExists(path))
+        return LoadImage(path);
+
+    sprintf(path, "assets/%s.bmp", baseName);
+    if (FileExists(path))
+        return LoadImage(path);
+
+    return (Image){0};
+}
+
+/* Resolves the clip table against the atlas. Until the sprites arrive the
+   clips keep their timing and tracks with one empty frame. */
+void ResolveClips(void)
+{
+    for (int i = 0; i < CLIP_COUNT; i++)
+    {
+        SpriteId sprite = (SpriteId)clipDefs[i].sprite;
+        Rectangle strip = AtlasHas(sprite) ? AtlasRect(sprite) : (Rectangle){0, 0, 0, 0};
+        AnimClipResolve(&clips[i], &clipDefs[i], strip);
+    }
+}
+
 void InitGame(void)
 {
     currentState = GAME_STATE_TITLE;
@@ -306,18 +394,23 @@ void InitGame(void)
         itemUsed[i] = false;
     }
 
-    player.hp = 120;
-    player.maxHp = 120;
-    boss.hp = 200;
-    boss.maxHp = 200;
-    boss.attack = 22;
+    ResolveClips();
+    EntityStoreClear(&battleEntities, clips);
+    playerEntity = EntityCreate(&battleEntities, PLAYER_START_HP, 0);
+    bossEntity = EntityCreate(&battleEntities, BOSS_START_HP, BOSS_START_ATTACK);
+    EntitySetClips(&battleEntities, PlayerSlot(), CLIP_PLAYER_ATTACK, CLIP_PLAYER_HURT);
+    EntitySetClips(&battleEntities, BossSlot(), CLIP_BOSS_ATTACK, CLIP_BOSS_HURT);
+    ParticlePoolClear(&battleParticles, 1);
+    if (endlessMode)
+        StageGenStart(gameSeed);
 
     battleState = BATTLE_PLAYER_TURN;
     selectedItemIndex = 0;
     playerHasArmor = false;
-    battleMessage = "Batalha contra o Chefe! Escolha seu item.";
-
-    srand((unsigned int)time(NULL));
+    BattleLogClear(&battleLog);
+    BattleLogPush(&battleLog, BATTLE_LOG_SYSTEM, BATTLE_LOG_START, 0);
+    battleLogScroll = 0;
+    battleLogExported = false;
 
     explorePlayerX = SCREEN_WIDTH / 2 - 10;
     explorePlayerY = 420;
@@ -327,55 +420,288 @@ void InitGame(void)
 
     if (!texturesInitialized)
     {
-        playerTexture = LoadAsset("boss_player/player");
-        bossTexture = LoadAsset("boss_player/boss");
+        PROF_BEGIN(PROF_ASSETS_INIT);
         titleBackgroundTexture = LoadAsset("cenarios/title_bg");
-        battleBackgroundTexture = LoadAsset("cenarios/battle_bg");
 
-        bgStage1 = LoadAsset("cenarios/cenario1");
-        bgStage2 = LoadAsset("cenarios/cenario2");
-        bgStage3 = LoadAsset("cenarios/cenario3");
-        bgStage4 = LoadAsset("cenarios/cenario4");
+        StreamInit();
+        stageAssetHandles[0] = TexMgrRegister("cenarios/cenario1", &bgStage1, SCREEN_WIDTH, SCREEN_HEIGHT);
+        stageAssetHandles[1] = TexMgrRegister("cenarios/cenario2", &bgStage2, SCREEN_WIDTH, SCREEN_HEIGHT);
+        stageAssetHandles[2] = TexMgrRegister("cenarios/cenario3", &bgStage3, SCREEN_WIDTH, SCREEN_HEIGHT);
+        stageAssetHandles[3] = TexMgrRegister("cenarios/cenario4", &bgStage4, SCREEN_WIDTH, SCREEN_HEIGHT);
+        battleBackgroundHandle = TexMgrRegister("cenarios/battle_bg", &battleBackgroundTexture, SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (int i = 0; i < SPRITE_COUNT; i++)
+            spriteAssetHandles[i] = StreamRegister(spriteAssetNames[i], NULL, 0, 0);
 
-        bossAttackTexture = LoadAsset("boss_attack");
-        playerHitTexture = LoadAsset("player_hit");
-        bossHitTexture = LoadAsset("boss_hit");
-        playerAttackTexture = LoadAsset("player_attack");
+        texturesInitialized = true;
+        PROF_END(PROF_ASSETS_INIT);
+    }
+}
 
-        bossAttackFrameCount = 1;
-        bossAttackFrameDuration = BOSS_ATTACK_DURATION;
-        if (bossAttackTexture.id != 0 && bossAttackTexture.height > 0)
-        {
-            bossAttackFrameCount = bossAttackTexture.width / bossAttackTexture.height;
-            if (bossAttackFrameCount < 1)
-                bossAttackFrameCount = 1;
-            bossAttackFrameDuration = BOSS_ATTACK_DURATION / (float)bossAttackFrameCount;
-        }
+/* Endless mode after a win: the inventory empties, the boss is back at full
+   health and the player keeps whatever health they had left. The battle log
+   keeps going, so an export covers the whole run. */
+void StartNextFloor(void)
+{
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        inventory[i] = ITEM_NONE;
+        itemUsed[i] = false;
+    }
+    inventoryCount = 0;
+    selectedItemIndex = 0;
+    playerHasArmor = false;
+    battleEntities.hp[BossSlot()] = battleEntities.maxHp[BossSlot()];
+    battleState = BATTLE_PLAYER_TURN;
+    battleLog.turn = 1;
+    BattleLogPush(&battleLog, BATTLE_LOG_SYSTEM, BATTLE_LOG_START, currentStage / STAGE_COUNT + 1);
+    battleLogScroll = 0;
+    battleLogExported = false;
+
+    explorePlayerX = SCREEN_WIDTH / 2 - 10;
+    renderPrev.explorePlayerX = explorePlayerX;
+    currentState = GAME_STATE_EXPLORE;
+}
+
+void SaveCombatantFrom(SaveCombatant *out, int slot)
+{
+    const EntityStore *e = &battleEntities;
+    out->hp = e->hp[slot];
+    out->maxHp = e->maxHp[slot];
+    out->attack = e->attack[slot];
+    out->attackFrame = AnimFrame(&e->anims, e->attackAnim[slot]);
+    out->attackTimer = AnimTimeLeft(&e->anims, e->attackAnim[slot]);
+    out->attackFrameTime = AnimFrameTime(&e->anims, e->attackAnim[slot]);
+    out->hurtTimer = AnimTimeLeft(&e->anims, e->hurtAnim[slot]);
+    out->reserved = 0;
+}
+
+void LoadCombatantInto(int slot, const SaveCombatant *in)
+{
+    EntityStore *e = &battleEntities;
+    e->hp[slot] = in->hp;
+    e->maxHp[slot] = in->maxHp;
+    e->attack[slot] = in->attack;
+    e->attackAnim[slot] =
+        AnimSetState(&e->anims, e->attackAnim[slot], e->attackClip[slot], in->attackTimer, in->attackFrame, in->attackFrameTime);
+    e->hurtAnim[slot] = AnimSetState(&e->anims, e->hurtAnim[slot], e->hurtClip[slot], in->hurtTimer, 0, 0.0f);
+}
+
+bool SaveCombatantValid(const SaveCombatant *c)
+{
+    return c->maxHp > 0 && c->hp >= 0 && c->hp <= c->maxHp && c->attack >= 0;
+}
+
+bool SaveGame(const char *path)
+{
+    SaveState state;
+    memset(&state, 0, sizeof(state));
+    state.seed = gameSeed;
+    memcpy(state.rng, combatRng.s, sizeof(state.rng));
+    state.gameState = (uint32_t)currentState;
+    state.battleState = (uint32_t)battleState;
+    state.currentStage = currentStage;
+    state.inventoryCount = inventoryCount;
+    state.selectedItemIndex = selectedItemIndex;
+    state.lastItemCollected = (int32_t)lastItemCollected;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        state.inventory[i] = (uint8_t)inventory[i];
+        state.itemUsed[i] = itemUsed[i] ? 1 : 0;
+    }
+    state.playerHasArmor = playerHasArmor ? 1 : 0;
+    state.endless = endlessMode ? 1 : 0;
+    state.itemMessageTimer = itemMessageTimer;
+    state.bossTurnTimer = bossTurnTimer;
+    state.explorePlayerX = explorePlayerX;
+    state.explorePlayerY = explorePlayerY;
+    SaveCombatantFrom(&state.player, PlayerSlot());
+    SaveCombatantFrom(&state.boss, BossSlot());
+    state.logTotal = battleLog.total;
+    state.logTurn = battleLog.turn;
+    BattleLogSnapshot(&battleLog, state.log, BATTLE_LOG_CAPACITY);
+    return SaveStateWrite(path, &state);
+}
+
+/* Restores a save over a freshly initialized game. Anything out of range is
+   treated as a bad file and leaves the game untouched. */
+bool LoadGame(const char *path)
+{
+    SaveState state;
+    if (!SaveStateRead(path, &state))
+        return false;
+    if (state.gameState > GAME_STATE_ENDING_ESCAPE || state.battleState > BATTLE_BOSS_TURN ||
+        state.currentStage < 0 || (!state.endless && state.currentStage > STAGE_COUNT) || state.inventoryCount < 0 ||
+        state.inventoryCount > INVENTORY_SIZE || state.selectedItemIndex < 0 || state.selectedItemIndex >= INVENTORY_SIZE ||
+        state.lastItemCollected < ITEM_NONE || state.lastItemCollected > ITEM_ARMOR || !SaveCombatantValid(&state.player) ||
+        !SaveCombatantValid(&state.boss))
+        return false;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        if (state.inventory[i] > ITEM_ARMOR)
+            return false;
+    }
+
+    gameSeed = state.seed;
+    memcpy(combatRng.s, state.rng, sizeof(state.rng));
+    currentState = (GameState)state.gameState;
+    battleState = (BattleState)state.battleState;
+    currentStage = state.currentStage;
+    inventoryCount = state.inventoryCount;
+    selectedItemIndex = state.selectedItemIndex;
+    lastItemCollected = (ItemType)state.lastItemCollected;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        inventory[i] = (ItemType)state.inventory[i];
+        itemUsed[i] = state.itemUsed[i] != 0;
+    }
+    playerHasArmor = state.playerHasArmor != 0;
+    endlessMode = state.endless != 0;
+    if (endlessMode)
+        StageGenStart(gameSeed);
+    itemMessageTimer = state.itemMessageTimer;
+    bossTurnTimer = state.bossTurnTimer;
+    explorePlayerX = state.explorePlayerX;
+    explorePlayerY = state.explorePlayerY;
+    LoadCombatantInto(PlayerSlot(), &state.player);
+    LoadCombatantInto(BossSlot(), &state.boss);
+    BattleLogRestore(&battleLog, state.logTotal, state.logTurn, state.log, BATTLE_LOG_CAPACITY);
+    return true;
+}
+
+void SpectateCombatantFrom(SpectateCombatant *out, int slot)
+{
+    const EntityStore *e = &battleEntities;
+    out->hp = e->hp[slot];
+    out->maxHp = e->maxHp[slot];
+    out->attackFrame = AnimFrame(&e->anims, e->attackAnim[slot]);
+    out->attackTimer = AnimTimeLeft(&e->anims, e->attackAnim[slot]);
+    out->hurtTimer = AnimTimeLeft(&e->anims, e->hurtAnim[slot]);
+}
+
+void SpectateCombatantInto(int slot, const SpectateCombatant *in)
+{
+    EntityStore *e = &battleEntities;
+    e->hp[slot] = in->hp;
+    e->maxHp[slot] = in->maxHp > 0 ? in->maxHp : 1;
+    e->attackAnim[slot] = AnimSetState(&e->anims, e->attackAnim[slot], e->attackClip[slot], in->attackTimer, in->attackFrame, 0.0f);
+    e->hurtAnim[slot] = AnimSetState(&e->anims, e->hurtAnim[slot], e->hurtClip[slot], in->hurtTimer, 0, 0.0f);
+}
+
+/* Called after every logic step while --broadcast is on. */
+void BroadcastSpectators(void)
+{
+    SpectateState state;
+    memset(&state, 0, sizeof(state));
+    state.gameState = (uint32_t)currentState;
+    state.battleState = (uint32_t)battleState;
+    state.selectedItemIndex = selectedItemIndex;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        state.inventory[i] = (uint8_t)inventory[i];
+        state.itemUsed[i] = itemUsed[i] ? 1 : 0;
+    }
+    state.playerHasArmor = playerHasArmor ? 1 : 0;
+    SpectateCombatantFrom(&state.player, PlayerSlot());
+    SpectateCombatantFrom(&state.boss, BossSlot());
+    state.logTotal = battleLog.total;
+    BattleLogSnapshot(&battleLog, state.log, SPECTATE_LOG_SIZE);
+    SpectatePublish(&spectatePublisher, &state);
+}
+
+/* Copies a received state into the globals DrawBattle reads. */
+void ApplySpectateState(const SpectateState *state)
+{
+    if (state->gameState > GAME_STATE_ENDING_ESCAPE || state->battleState > BATTLE_BOSS_TURN)
+        return;
+    currentState = (GameState)state->gameState;
+    battleState = (BattleState)state->battleState;
+    selectedItemIndex = ((unsigned)state->selectedItemIndex < INVENTORY_SIZE) ? state->selectedItemIndex : 0;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        inventory[i] = state->inventory[i] <= ITEM_ARMOR ? (ItemType)state->inventory[i] : ITEM_NONE;
+        itemUsed[i] = state->itemUsed[i] != 0;
+    }
+    playerHasArmor = state->playerHasArmor != 0;
+    SpectateCombatantInto(PlayerSlot(), &state->player);
+    SpectateCombatantInto(BossSlot(), &state->boss);
+    if (state->logTotal != battleLog.total)
+        BattleLogRestore(&battleLog, state->logTotal, 0, state->log, SPECTATE_LOG_SIZE);
+}
+
+/* Stage being explored in endless mode: the workers' copy once it is
+   generated, otherwise its text and items built here, so a door never waits
+   on a background. */
+const StageContent *EndlessStage(void)
+{
+    const GeneratedStage *stage = StageGenPeek(currentStage);
+    if (stage)
+        return &stage->content;
+    if (endlessContent.index != currentStage || endlessContent.story[0] == '\0')
+        StageGenContent(&endlessContent, gameSeed, currentStage);
+    return &endlessContent;
+}
+
+/* Moves the generators' window to the current stage and swaps in its
+   background once generated; the previous stage's texture is dropped. */
+void UpdateEndlessStages(void)
+{
+    StageGenSetWindow(currentStage);
+    if (endlessBackgroundStage == currentStage)
+        return;
+    const GeneratedStage *stage = StageGenPeek(currentStage);
+    if (!stage || !stage->background.data)
+        return;
+    if (endlessBackground.id)
+        UnloadTexture(endlessBackground);
+    endlessBackground = LoadTextureFromImage(stage->background);
+    endlessBackgroundStage = currentStage;
+}
+
+void UpdateAssetStreaming(void)
+{
+    for (int i = 0; i < SPRITE_COUNT; i++)
+        StreamRequest(spriteAssetHandles[i]);
+
+    bool exploring = currentState == GAME_STATE_EXPLORE;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        bool wanted = (currentState == GAME_STATE_TITLE && i == 0) ||
+                      (exploring && !endlessMode && (i == currentStage || i == currentStage + 1));
+        TexMgrHold(stageAssetHandles[i], &stageAssetHeld[i], wanted);
+        if (i < currentStage)
+            TexMgrRetire(stageAssetHandles[i]);
+    }
+    TexMgrHold(battleBackgroundHandle, &battleBackgroundHeld,
+               currentState == GAME_STATE_BATTLE || (exploring && inventoryCount + 1 >= INVENTORY_SIZE));
+    if (endlessMode)
+        UpdateEndlessStages();
 
-        playerAttackFrameCount = 1;
-        playerAttackFrameDuration = PLAYER_ATTACK_DURATION;
-        if (playerAttackTexture.id != 0 && playerAttackTexture.height > 0)
+    StreamUpdate(STREAM_UPLOAD_BUDGET);
+    TexMgrUpdate();
+
+    if (!spritesReady)
+    {
+        for (int i = 0; i < SPRITE_COUNT; i++)
         {
-            playerAttackFrameCount = playerAttackTexture.width / playerAttackTexture.height;
-            if (playerAttackFrameCount < 1)
-                playerAttackFrameCount = 1;
-            playerAttackFrameDuration = PLAYER_ATTACK_DURATION / (float)playerAttackFrameCount;
+            if (!StreamIsSettled(spriteAssetHandles[i]))
+                return;
         }
 
-        texturesInitialized = true;
+        Image images[SPRITE_COUNT];
+        for (int i = 0; i < SPRITE_COUNT; i++)
+            images[i] = StreamTakeImage(spriteAssetHandles[i]);
+        AtlasBuildFromImages(images);
+        ResolveClips();
+        spritesReady = true;
     }
-
-    bossIsAttacking = false;
-    bossAttackTimer = 0.0f;
-    bossHurtTimer = 0.0f;
 }
 
 void UpdateExplore(void)
 {
     if (itemMessageTimer > 0)
     {
-        itemMessageTimer -= GetFrameTime();
-        if (itemMessageTimer <= 0 && currentStage >= 4)
+        itemMessageTimer -= InputFrameTime();
+        if (itemMessageTimer <= 0 && inventoryCount >= INVENTORY_SIZE)
         {
             currentState = GAME_STATE_BATTLE;
             battleState = BATTLE_PLAYER_TURN;
@@ -383,10 +709,10 @@ void UpdateExplore(void)
         return;
     }
 
-    float delta = GetFrameTime();
-    if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D))
+    float delta = InputFrameTime();
+    if (InputKeyDown(KEY_RIGHT) || InputKeyDown(KEY_D))
         explorePlayerX += explorePlayerSpeed * delta;
-    if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
+    if (InputKeyDown(KEY_LEFT) || InputKeyDown(KEY_A))
         explorePlayerX -= explorePlayerSpeed * delta;
 
     if (explorePlayerX < 60)
@@ -394,7 +720,7 @@ void UpdateExplore(void)
     if (explorePlayerX > SCREEN_WIDTH - 80)
         explorePlayerX = SCREEN_WIDTH - 80;
 
-    if (IsKeyPressed(KEY_ENTER))
+    if (InputKeyPressed(KEY_ENTER))
     {
         Rectangle playerRect = (Rectangle){explorePlayerX - 5, explorePlayerY - 10, 30, 60};
         int chosen = -1;
@@ -405,7 +731,7 @@ void UpdateExplore(void)
 
         if (chosen != -1)
         {
-            lastItemCollected = GetItemForChoice(currentStage, chosen);
+            lastItemCollected = endlessMode ? EndlessStage()->item[chosen] : GetItemForChoice(currentStage, chosen);
             if (inventoryCount < INVENTORY_SIZE)
             {
                 inventory[inventoryCount] = lastItemCollected;
@@ -414,78 +740,44 @@ void UpdateExplore(void)
             currentStage++;
             itemMessageTimer = 2.0f;
             explorePlayerX = SCREEN_WIDTH / 2 - 10;
+            renderPrev.explorePlayerX = explorePlayerX;
         }
     }
 }
 
 void UpdateBattle(void)
 {
-    float delta = GetFrameTime();
+    float delta = InputFrameTime();
+    EntityTick(&battleEntities, delta);
+    ParticleUpdate(&battleParticles, delta, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-    if (playerIsAttacking)
-    {
-        playerAttackTimer -= delta;
-        if (playerAttackTimer <= 0.0f)
-            playerIsAttacking = false;
-
-        if (playerAttackFrameCount > 1)
-        {
-            playerAttackFrameTime += delta;
-            if (playerAttackFrameTime >= playerAttackFrameDuration)
-            {
-                playerAttackFrameTime -= playerAttackFrameDuration;
-                playerAttackFrame = (playerAttackFrame + 1) % playerAttackFrameCount;
-            }
-        }
-    }
-
-    if (bossIsAttacking)
-    {
-        bossAttackTimer -= delta;
-        if (bossAttackTimer <= 0.0f)
-            bossIsAttacking = false;
-
-        if (bossAttackFrameCount > 1)
-        {
-            bossAttackFrameTime += delta;
-            if (bossAttackFrameTime >= bossAttackFrameDuration)
-            {
-                bossAttackFrameTime -= bossAttackFrameDuration;
-                bossAttackFrame = (bossAttackFrame + 1) % bossAttackFrameCount;
-            }
-        }
-    }
-
-    if (bossHurtTimer > 0.0f)
-        bossHurtTimer -= delta;
-    if (playerHurtTimer > 0.0f)
-        playerHurtTimer -= delta;
-
-    if (boss.hp <= 0)
+    if (battleEntities.hp[BossSlot()] <= 0)
     {
+        BattleLogPush(&battleLog, BATTLE_LOG_SYSTEM, BATTLE_LOG_VICTORY, 0);
         currentState = GAME_STATE_ENDING_GOOD;
         return;
     }
-    if (player.hp <= 0)
+    if (battleEntities.hp[PlayerSlot()] <= 0)
     {
+        BattleLogPush(&battleLog, BATTLE_LOG_SYSTEM, BATTLE_LOG_DEFEAT, 0);
         currentState = GAME_STATE_ENDING_BAD;
         return;
     }
 
     if (battleState == BATTLE_PLAYER_TURN)
     {
-        if (IsKeyPressed(KEY_RIGHT))
+        if (InputKeyPressed(KEY_RIGHT))
             selectedItemIndex = (selectedItemIndex + 1) % INVENTORY_SIZE;
-        if (IsKeyPressed(KEY_LEFT))
+        if (InputKeyPressed(KEY_LEFT))
             selectedItemIndex = (selectedItemIndex - 1 + INVENTORY_SIZE) % INVENTORY_SIZE;
-        if (IsKeyPressed(KEY_A))
+        if (InputKeyPressed(KEY_A))
             PlayerAttack();
-        if (IsKeyPressed(KEY_ENTER))
+        if (InputKeyPressed(KEY_ENTER))
             UseItem(selectedItemIndex);
     }
     else if (battleState == BATTLE_BOSS_TURN)
     {
-        bossTurnTimer -= GetFrameTime();
+        bossTurnTimer -= delta;
         if (bossTurnTimer <= 0)
         {
             BossAttack();
@@ -496,12 +788,34 @@ void UpdateBattle(void)
 
 void UpdateTitleScreen(void)
 {
-    if (IsKeyPressed(KEY_ENTER))
+    if (InputKeyPressed(KEY_ENTER))
     {
         currentState = GAME_STATE_EXPLORE;
     }
 }
 
+float PlayerAttackOffset(void)
+{
+    const EntityStore *e = &battleEntities;
+    return AnimTrackValue(&e->anims, e->attackAnim[PlayerSlot()], ANIM_TRACK_OFFSET_X, 0.0f);
+}
+
+float BossAttackOffset(void)
+{
+    const EntityStore *e = &battleEntities;
+    return AnimTrackValue(&e->anims, e->attackAnim[BossSlot()], ANIM_TRACK_OFFSET_X, 0.0f);
+}
+
+RenderSnapshot CaptureRenderState(void)
+{
+    return (RenderSnapshot){explorePlayerX, PlayerAttackOffset(), BossAttackOffset()};
+}
+
+float RenderLerp(float previous, float current)
+{
+    return previous + (current - previous) * renderAlpha;
+}
+
 void DrawPlayerSprite(int posX, int posY)
 {
     DrawCircle(posX + 10, posY - 10, 10, (Color){255, 200, 150, 255});
@@ -520,7 +834,9 @@ void DrawExplore(void)
 {
     Texture2D currentBg = {0};
 
-    if (currentStage == 0)
+    if (endlessMode)
+        currentBg = (endlessBackgroundStage == currentStage) ? endlessBackground : (Texture2D){0};
+    else if (currentStage == 0)
         currentBg = bgStage1;
     else if (currentStage == 1)
         currentBg = bgStage2;
@@ -544,75 +860,76 @@ void DrawExplore(void)
     }
 
     if (itemMessageTimer > 0)
-    {
-        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color){0, 0, 0, 200});
-        DrawRectangle(SCREEN_WIDTH / 2 - 300, SCREEN_HEIGHT / 2 - 100, 600, 200, (Color){50, 50, 100, 255});
-        DrawRectangleLines(SCREEN_WIDTH / 2 - 300, SCREEN_HEIGHT / 2 - 100, 600, 200, (Color){100, 200, 255, 255});
-
-        sprintf(messageBuffer, "Voce coletou: %s!", GetItemName(lastItemCollected));
-        int textWidth = MeasureText(messageBuffer, 30);
-        DrawText(messageBuffer, SCREEN_WIDTH / 2 - textWidth / 2, SCREEN_HEIGHT / 2 - 50, 30, (Color){100, 255, 150, 255});
-        DrawText("Carregando proximo cenario...", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 + 40, 18, (Color){150, 150, 200, 255});
         return;
-    }
 
-    const char *storyText = "";
-    const char *leftDoorLabel = "Porta A";
-    const char *rightDoorLabel = "Porta B";
+    DrawRectangleRec(doorLeftRect, (Color){255, 255, 255, 30});
+    DrawRectangleRec(doorRightRect, (Color){255, 255, 255, 30});
 
-    switch (currentStage)
+    float playerX = RenderLerp(renderPrev.explorePlayerX, explorePlayerX);
+    if (texturesInitialized && AtlasHas(SPRITE_PLAYER))
     {
-    case 0:
-        storyText = "Voce chega aos portoes do Castelo exausto.\nPrecisa recuperar as forcas antes de entrar.";
-        leftDoorLabel = "Beber da Fonte";
-        rightDoorLabel = "Comer Frutas";
-        break;
-    case 1:
-        storyText = "No arsenal abandonado, voce ve duas armas.\nQual estilo de combate voce prefere?";
-        leftDoorLabel = "Espada Antiga";
-        rightDoorLabel = "Bomba Caseira";
-        break;
-    case 2:
-        storyText = "Um esqueleto segura dois itens valiosos.\nVoce prioriza protecao ou tenta subornar o chefe?";
-        leftDoorLabel = "Armadura Leve";
-        rightDoorLabel = "Bolsa de Ouro";
-        break;
-    case 3:
-        storyText = "A porta do trono esta a frente. O medo gela a espinha.\nUltima chance de curar ferimentos.";
-        leftDoorLabel = "Usar Curativos";
-        rightDoorLabel = "Tonico Vital";
-        break;
+        Rectangle frame = AtlasRect(SPRITE_PLAYER);
+        Rectangle src = {0, 0, frame.width, frame.height};
+        Vector2 origin = {frame.width / 2.0f, frame.height / 2.0f};
+        Rectangle dest = {playerX + 10, explorePlayerY + frame.height / 2.0f, frame.width, frame.height};
+        SpriteBatchPush(SPRITE_PLAYER, src, dest, origin, WHITE, SPRITE_LAYER_ACTOR);
     }
+    else
+    {
+        DrawPlayerSprite((int)playerX, (int)explorePlayerY);
+    }
+    SpriteBatchFlush();
+}
 
-    DrawText(storyText, 82, 62, 22, BLACK);
-    DrawText(storyText, 80, 60, 22, WHITE);
-
-    DrawRectangleRec(doorLeftRect, (Color){255, 255, 255, 30});
+void DrawExploreHud(void)
+{
+    if (itemMessageTimer > 0)
+    {
+        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color){0, 0, 0, 200});
+        LayerDraw(&itemMessageLayer);
+        return;
+    }
     DrawRectangleLines((int)doorLeftRect.x, (int)doorLeftRect.y, (int)doorLeftRect.width, (int)doorLeftRect.height, YELLOW);
-
-    DrawText(leftDoorLabel, (int)doorLeftRect.x + 12, (int)doorLeftRect.y + 92, 16, BLACK);
-    DrawText(leftDoorLabel, (int)doorLeftRect.x + 10, (int)doorLeftRect.y + 90, 16, WHITE);
-
-    DrawRectangleRec(doorRightRect, (Color){255, 255, 255, 30});
     DrawRectangleLines((int)doorRightRect.x, (int)doorRightRect.y, (int)doorRightRect.width, (int)doorRightRect.height, YELLOW);
+    LayerDraw(&exploreStoryLayer);
+    LayerDraw(&exploreDoorLayers[0]);
+    LayerDraw(&exploreDoorLayers[1]);
+    LayerDraw(&exploreHintLayer);
+}
 
-    DrawText(rightDoorLabel, (int)doorRightRect.x + 12, (int)doorRightRect.y + 92, 16, BLACK);
-    DrawText(rightDoorLabel, (int)doorRightRect.x + 10, (int)doorRightRect.y + 90, 16, WHITE);
-
-    if (texturesInitialized && playerTexture.id != 0)
+/* Pushes a combatant's current attack frame (or its idle sprite) and the
+   hit overlay of its hurt clip, tinted by the hurt clip's flash track.
+   Returns false until the atlas has the idle sprite. */
+bool PushCombatant(int slot, SpriteId idle, float x, float groundY)
+{
+    if (!texturesInitialized || !AtlasHas(idle))
+        return false;
+
+    const EntityStore *e = &battleEntities;
+    const AnimPool *anims = &e->anims;
+    Color tint = Fade(WHITE, AnimTrackValue(anims, e->hurtAnim[slot], ANIM_TRACK_ALPHA, 1.0f));
+
+    SpriteId sprite = idle;
+    Rectangle src = AtlasRect(idle);
+    src.x = src.y = 0;
+    int attack = AnimSprite(anims, e->attackAnim[slot]);
+    if (attack >= 0 && AtlasHas((SpriteId)attack))
     {
-        Rectangle src = {0, 0, (float)playerTexture.width, (float)playerTexture.height};
-        Vector2 origin = {playerTexture.width / 2.0f, playerTexture.height / 2.0f};
-        Rectangle dest = {explorePlayerX + 10, explorePlayerY + playerTexture.height / 2.0f, (float)playerTexture.width, (float)playerTexture.height};
-        DrawTexturePro(playerTexture, src, dest, origin, 0.0f, WHITE);
+        sprite = (SpriteId)attack;
+        src = AnimFrameRect(anims, e->attackAnim[slot]);
     }
-    else
+
+    Vector2 origin = {src.width / 2, src.height / 2.0f};
+    Rectangle dest = {x, groundY - src.height / 2.0f, src.width, src.height};
+    SpriteBatchPush(sprite, src, dest, origin, tint, SPRITE_LAYER_ACTOR);
+
+    int hit = AnimSprite(anims, e->hurtAnim[slot]);
+    if (hit >= 0 && AtlasHas((SpriteId)hit))
     {
-        DrawPlayerSprite((int)explorePlayerX, (int)explorePlayerY);
+        Rectangle hitSrc = AnimFrameRect(anims, e->hurtAnim[slot]);
+        SpriteBatchPush((SpriteId)hit, hitSrc, (Rectangle){x, dest.y, hitSrc.width, hitSrc.height}, origin, WHITE, SPRITE_LAYER_EFFECT);
     }
-
-    DrawText("Use SETAS ou A/D e [ENTER] na porta.", 82, SCREEN_HEIGHT - 38, 16, BLACK);
-    DrawText("Use SETAS ou A/D e [ENTER] na porta.", 80, SCREEN_HEIGHT - 40, 16, WHITE);
+    return true;
 }
 
 void DrawBattle(void)
@@ -627,126 +944,313 @@ void DrawBattle(void)
         ClearBackground((Color){30, 30, 50, 255});
     }
 
-    const int BAR_MARGIN = 20;
-    const int BAR_W = 300;
-    const int BAR_H = 25;
-
-    DrawText("Player (voce)", BAR_MARGIN, BAR_MARGIN, 22, (Color){150, 200, 255, 255});
-    DrawRectangle(BAR_MARGIN, BAR_MARGIN + 35, BAR_W, BAR_H, (Color){50, 50, 80, 255});
-    DrawRectangle(BAR_MARGIN, BAR_MARGIN + 35, (int)(BAR_W * ((float)player.hp / player.maxHp)), BAR_H, (Color){50, 200, 100, 255});
-    DrawRectangleLines(BAR_MARGIN, BAR_MARGIN + 35, BAR_W, BAR_H, WHITE);
-    DrawText(TextFormat("HP: %d / %d", player.hp, player.maxHp), BAR_MARGIN + 80, BAR_MARGIN + 37, 20, WHITE);
+    float bossX = BATTLE_BOSS_X + RenderLerp(renderPrev.bossAttackOffset, BossAttackOffset());
+    if (!PushCombatant(BossSlot(), SPRITE_BOSS, bossX, BATTLE_GROUND_Y))
+        DrawBossSprite((int)bossX - 20, (int)BATTLE_GROUND_Y - 120);
 
-    int bossBarX = SCREEN_WIDTH - BAR_W - BAR_MARGIN;
-    DrawText("Boss", bossBarX, BAR_MARGIN, 22, (Color){255, 100, 100, 255});
-    DrawRectangle(bossBarX, BAR_MARGIN + 35, BAR_W, BAR_H, (Color){50, 50, 80, 255});
-    DrawRectangle(bossBarX, BAR_MARGIN + 35, (int)(BAR_W * ((float)boss.hp / boss.maxHp)), BAR_H, (Color){255, 50, 50, 255});
-    DrawRectangleLines(bossBarX, BAR_MARGIN + 35, BAR_W, BAR_H, WHITE);
-    DrawText(TextFormat("HP: %d / %d", boss.hp, boss.maxHp), bossBarX + 80, BAR_MARGIN + 37, 20, WHITE);
+    float playerX = BATTLE_PLAYER_X + RenderLerp(renderPrev.playerAttackOffset, PlayerAttackOffset());
+    if (!PushCombatant(PlayerSlot(), SPRITE_PLAYER, playerX, BATTLE_GROUND_Y))
+        DrawPlayerSprite((int)playerX - 10, (int)BATTLE_GROUND_Y - 60);
+    SpriteBatchFlush();
+    ParticleDraw(&battleParticles);
+}
 
-    const float GROUND_Y = 480.0f;
-    Vector2 posB = {SCREEN_WIDTH - 250.0f, GROUND_Y};
-    float bossOffX = 0;
-    if (bossIsAttacking)
-        bossOffX = -((posB.x - 550.0f) * sinf((1.0f - bossAttackTimer / BOSS_ATTACK_DURATION) * 3.14f));
+void DrawBattleHud(void)
+{
+    LayerDraw(&battleBarsLayer);
+    LayerDraw(&battleItemsLayer);
+    LayerDraw(&battleTextLayer);
+    LayerDraw(&battleLogLayer);
+}
 
-    float bossAlpha = (bossHurtTimer > 0 && ((int)(bossHurtTimer * 30) % 2 == 0)) ? 0.5f : 1.0f;
-    Color bossTint = Fade(WHITE, bossAlpha);
+/* White text with a black shadow 2 px down and right, cached in a layer
+   sized to the measured text (MeasureTextEx also counts the extra lines). */
+void UpdateShadowTextLayer(Layer *layer, const char *text, int x, int y, int size, uint64_t key)
+{
+    Vector2 extent = MeasureTextEx(GetFontDefault(), text, (float)size, (float)(size / 10));
+    Rectangle bounds = {(float)x, (float)y, ceilf(extent.x) + 2, ceilf(extent.y) + 2};
+    if (!LayerBegin(layer, bounds, key))
+        return;
+    DrawText(text, x + 2, y + 2, size, BLACK);
+    DrawText(text, x, y, size, WHITE);
+    LayerEnd();
+}
 
-    if (texturesInitialized && bossTexture.id != 0)
+void UpdateExploreLayers(void)
+{
+    if (itemMessageTimer > 0)
     {
-        Texture2D tex = bossTexture;
-        if (bossIsAttacking && bossAttackTexture.id != 0)
-            tex = bossAttackTexture;
-
-        float w = (float)tex.width;
-        if (bossIsAttacking && bossAttackFrameCount > 1)
-            w /= bossAttackFrameCount;
+        Rectangle panel = {SCREEN_WIDTH / 2 - 300, SCREEN_HEIGHT / 2 - 100, 600, 200};
+        if (LayerBegin(&itemMessageLayer, panel, LayerHashInt(LAYER_KEY_SEED, lastItemCollected)))
+        {
+            DrawRectangleRec(panel, (Color){50, 50, 100, 255});
+            DrawRectangleLines((int)panel.x, (int)panel.y, (int)panel.width, (int)panel.height, (Color){100, 200, 255, 255});
+
+            const char *text = TextFormat("Voce coletou: %s!", GetItemName(lastItemCollected));
+            int textWidth = MeasureText(text, 30);
+            DrawText(text, SCREEN_WIDTH / 2 - textWidth / 2, SCREEN_HEIGHT / 2 - 50, 30, (Color){100, 255, 150, 255});
+            DrawText("Carregando proximo cenario...", SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT / 2 + 40, 18, (Color){150, 150, 200, 255});
+            LayerEnd();
+        }
+        return;
+    }
 
-        Rectangle src = {bossIsAttacking ? bossAttackFrame * w : 0, 0, w, (float)tex.height};
-        Vector2 origin = {w / 2, tex.height / 2.0f};
-        DrawTexturePro(tex, src, (Rectangle){posB.x + bossOffX, posB.y - tex.height / 2.0f, w, (float)tex.height}, origin, 0, bossTint);
+    const char *storyText = "";
+    const char *leftDoorLabel = "Porta A";
+    const char *rightDoorLabel = "Porta B";
 
-        if (bossHurtTimer > 0 && bossHitTexture.id != 0)
-            DrawTexturePro(bossHitTexture, (Rectangle){0, 0, (float)bossHitTexture.width, (float)bossHitTexture.height},
-                           (Rectangle){posB.x + bossOffX, posB.y - tex.height / 2.0f, (float)bossHitTexture.width, (float)bossHitTexture.height}, origin, 0, WHITE);
+    if (endlessMode)
+    {
+        const StageContent *stage = EndlessStage();
+        storyText = stage->story;
+        leftDoorLabel = stage->doorLabel[0];
+        rightDoorLabel = stage->doorLabel[1];
     }
     else
     {
-        DrawBossSprite((int)(posB.x + bossOffX) - 20, (int)GROUND_Y - 120);
+        switch (currentStage)
+        {
+        case 0:
+            storyText = "Voce chega aos portoes do Castelo exausto.\nPrecisa recuperar as forcas antes de entrar.";
+            leftDoorLabel = "Beber da Fonte";
+            rightDoorLabel = "Comer Frutas";
+            break;
+        case 1:
+            storyText = "No arsenal abandonado, voce ve duas armas.\nQual estilo de combate voce prefere?";
+            leftDoorLabel = "Espada Antiga";
+            rightDoorLabel = "Bomba Caseira";
+            break;
+        case 2:
+            storyText = "Um esqueleto segura dois itens valiosos.\nVoce prioriza protecao ou tenta subornar o chefe?";
+            leftDoorLabel = "Armadura Leve";
+            rightDoorLabel = "Bolsa de Ouro";
+            break;
+        case 3:
+            storyText = "A porta do trono esta a frente. O medo gela a espinha.\nUltima chance de curar ferimentos.";
+            leftDoorLabel = "Usar Curativos";
+            rightDoorLabel = "Tonico Vital";
+            break;
+        }
     }
 
-    int baseX = 250;
-    float atkOffX = 0;
-    if (playerIsAttacking)
-        atkOffX = (450.0f - baseX) * sinf((1.0f - playerAttackTimer / PLAYER_ATTACK_DURATION) * 3.14f);
+    uint64_t key = LayerHashInt(LayerHashInt(LAYER_KEY_SEED, currentStage), endlessMode);
+    UpdateShadowTextLayer(&exploreStoryLayer, storyText, 80, 60, 22, key);
+    UpdateShadowTextLayer(&exploreDoorLayers[0], leftDoorLabel, (int)doorLeftRect.x + 10, (int)doorLeftRect.y + 90, 16, key);
+    UpdateShadowTextLayer(&exploreDoorLayers[1], rightDoorLabel, (int)doorRightRect.x + 10, (int)doorRightRect.y + 90, 16, key);
+    UpdateShadowTextLayer(&exploreHintLayer, "Use SETAS ou A/D e [ENTER] na porta.", 80, SCREEN_HEIGHT - 40, 16, LAYER_KEY_SEED);
+}
 
-    float playerAlpha = (playerHurtTimer > 0 && ((int)(playerHurtTimer * 30) % 2 == 0)) ? 0.5f : 1.0f;
-    Color playerTint = Fade(WHITE, playerAlpha);
+void UpdateBattleLayers(void)
+{
+    const int BAR_MARGIN = 20;
+    const int BAR_W = 300;
+    const int BAR_H = 25;
 
-    if (texturesInitialized && playerTexture.id != 0)
+    const EntityStore *e = &battleEntities;
+    int p = PlayerSlot(), b = BossSlot();
+    uint64_t key = LayerHashInt(LAYER_KEY_SEED, e->hp[p]);
+    key = LayerHashInt(key, e->maxHp[p]);
+    key = LayerHashInt(key, e->hp[b]);
+    key = LayerHashInt(key, e->maxHp[b]);
+    if (LayerBegin(&battleBarsLayer, (Rectangle){0, 0, SCREEN_WIDTH, BAR_MARGIN + 35 + BAR_H}, key))
     {
-        Texture2D tex = playerTexture;
-        if (playerIsAttacking && playerAttackTexture.id != 0)
-            tex = playerAttackTexture;
+        DrawText("Player (voce)", BAR_MARGIN, BAR_MARGIN, 22, (Color){150, 200, 255, 255});
+        DrawRectangle(BAR_MARGIN, BAR_MARGIN + 35, BAR_W, BAR_H, (Color){50, 50, 80, 255});
+        DrawRectangle(BAR_MARGIN, BAR_MARGIN + 35, (int)(BAR_W * ((float)e->hp[p] / e->maxHp[p])), BAR_H, (Color){50, 200, 100, 255});
+        DrawRectangleLines(BAR_MARGIN, BAR_MARGIN + 35, BAR_W, BAR_H, WHITE);
+        DrawText(TextFormat("HP: %d / %d", e->hp[p], e->maxHp[p]), BAR_MARGIN + 80, BAR_MARGIN + 37, 20, WHITE);
+
+        int bossBarX = SCREEN_WIDTH - BAR_W - BAR_MARGIN;
+        DrawText("Boss", bossBarX, BAR_MARGIN, 22, (Color){255, 100, 100, 255});
+        DrawRectangle(bossBarX, BAR_MARGIN + 35, BAR_W, BAR_H, (Color){50, 50, 80, 255});
+        DrawRectangle(bossBarX, BAR_MARGIN + 35, (int)(BAR_W * ((float)e->hp[b] / e->maxHp[b])), BAR_H, (Color){255, 50, 50, 255});
+        DrawRectangleLines(bossBarX, BAR_MARGIN + 35, BAR_W, BAR_H, WHITE);
+        DrawText(TextFormat("HP: %d / %d", e->hp[b], e->maxHp[b]), bossBarX + 80, BAR_MARGIN + 37, 20, WHITE);
+        LayerEnd();
+    }
 
-        float w = (float)tex.width;
-        if (playerIsAttacking && playerAttackFrameCount > 1)
-            w /= playerAttackFrameCount;
+    key = LayerHashInt(LAYER_KEY_SEED, selectedItemIndex);
+    key = LayerHash(key, inventory, sizeof(inventory));
+    key = LayerHash(key, itemUsed, sizeof(itemUsed));
+    key = LayerHashInt(key, winOddsReady ? (int)(winChance * 1000.0f + 0.5f) : -1);
+    key = LayerHashInt(key, winOddsReady && battleState == BATTLE_PLAYER_TURN ? winAction : INVENTORY_SIZE);
+    if (LayerBegin(&battleItemsLayer, (Rectangle){0, SCREEN_HEIGHT - 110, SCREEN_WIDTH, 80}, key))
+    {
+        bool showBest = winOddsReady && battleState == BATTLE_PLAYER_TURN;
+        if (winOddsReady)
+        {
+            const char *odds = TextFormat("Chance de vitoria: %.1f%%", 100.0f * winChance);
+            if (showBest)
+                odds = TextFormat("%s   Melhor jogada: %s", odds, winAction == ACTION_ATTACK ? "Atacar" : GetItemShortName(inventory[winAction]));
+            DrawText(odds, 20, SCREEN_HEIGHT - 100, 18, GOLD);
+        }
 
-        Rectangle src = {playerIsAttacking ? playerAttackFrame * w : 0, 0, w, (float)tex.height};
-        Vector2 origin = {w / 2, tex.height / 2.0f};
-        DrawTexturePro(tex, src, (Rectangle){baseX + atkOffX, GROUND_Y - tex.height / 2.0f, w, (float)tex.height}, origin, 0, playerTint);
+        int itemPosX = 20;
+        for (int i = 0; i < INVENTORY_SIZE; i++)
+        {
+            Color bgColor = (i == selectedItemIndex) ? (Color){100, 200, 255, 255} : (Color){50, 50, 100, 255};
+            DrawRectangle(itemPosX, SCREEN_HEIGHT - 70, 180, 40, bgColor);
+            DrawRectangleLines(itemPosX, SCREEN_HEIGHT - 70, 180, 40, LIGHTGRAY);
+            if (showBest && winAction == i)
+                DrawRectangleLinesEx((Rectangle){itemPosX - 3, SCREEN_HEIGHT - 73, 186, 46}, 3, GOLD);
+
+            Color txtColor = itemUsed[i] ? GRAY : (i == selectedItemIndex ? BLACK : WHITE);
+            const char *name = (inventory[i] == ITEM_SWORD || inventory[i] == ITEM_ARMOR) ? "Vazio" : GetItemName(inventory[i]);
+            DrawText(name, itemPosX + 5, SCREEN_HEIGHT - 58, 12, txtColor);
+            itemPosX += 200;
+        }
 
-        if (playerHurtTimer > 0 && playerHitTexture.id != 0)
-            DrawTexturePro(playerHitTexture, (Rectangle){0, 0, (float)playerHitTexture.width, (float)playerHitTexture.height},
-                           (Rectangle){baseX + atkOffX, GROUND_Y - tex.height / 2.0f, (float)playerHitTexture.width, (float)playerHitTexture.height}, origin, 0, WHITE);
+        DrawRectangle(SCREEN_WIDTH - 150, SCREEN_HEIGHT - 85, 130, 45, RED);
+        DrawRectangleLines(SCREEN_WIDTH - 150, SCREEN_HEIGHT - 85, 130, 45, MAROON);
+        if (showBest && winAction == ACTION_ATTACK)
+            DrawRectangleLinesEx((Rectangle){SCREEN_WIDTH - 153, SCREEN_HEIGHT - 88, 136, 51}, 3, GOLD);
+        DrawText("ATACAR [A]", SCREEN_WIDTH - 140, SCREEN_HEIGHT - 75, 16, WHITE);
+        LayerEnd();
     }
-    else
+
+    char line[BATTLE_LOG_LINE_SIZE];
+    const BattleLogEntry *newest = BattleLogRecent(&battleLog, 0);
+    if (LayerBegin(&battleTextLayer, (Rectangle){0, 100, SCREEN_WIDTH, 24}, LayerHashInt(LAYER_KEY_SEED, (int)battleLog.total)))
     {
-        DrawPlayerSprite(baseX + (int)atkOffX - 10, (int)GROUND_Y - 60);
+        if (newest)
+        {
+            BattleLogFormat(newest, line, sizeof(line));
+            DrawText(line, SCREEN_WIDTH / 2 - MeasureText(line, 20) / 2, 100, 20, YELLOW);
+        }
+        LayerEnd();
     }
 
-    int itemPosX = 20;
-    for (int i = 0; i < INVENTORY_SIZE; i++)
+    Rectangle panel = {20, 135, 460, 28 + BATTLE_LOG_VISIBLE * BATTLE_LOG_LINE_HEIGHT};
+    key = LayerHashInt(LayerHashInt(LAYER_KEY_SEED, (int)battleLog.total), battleLogScroll);
+    if (LayerBegin(&battleLogLayer, panel, key))
     {
-        Color bgColor = (i == selectedItemIndex) ? (Color){100, 200, 255, 255} : (Color){50, 50, 100, 255};
-        DrawRectangle(itemPosX, SCREEN_HEIGHT - 70, 180, 40, bgColor);
-        DrawRectangleLines(itemPosX, SCREEN_HEIGHT - 70, 180, 40, LIGHTGRAY);
+        DrawRectangleRec(panel, (Color){20, 20, 40, 255});
+        DrawRectangleLines((int)panel.x, (int)panel.y, (int)panel.width, (int)panel.height, (Color){100, 150, 200, 255});
+        int count = BattleLogCount(&battleLog);
+        DrawText("Registro [PgUp/PgDn]", (int)panel.x + 8, (int)panel.y + 6, 12, LIGHTGRAY);
+        if (battleLogScroll > 0)
+        {
+            const char *position = TextFormat("-%d de %d", battleLogScroll, count);
+            DrawText(position, (int)(panel.x + panel.width) - MeasureText(position, 12) - 8, (int)panel.y + 6, 12, GOLD);
+        }
 
-        Color txtColor = itemUsed[i] ? GRAY : (i == selectedItemIndex ? BLACK : WHITE);
-        const char *name = (inventory[i] == ITEM_SWORD || inventory[i] == ITEM_ARMOR) ? "Vazio" : GetItemName(inventory[i]);
-        DrawText(name, itemPosX + 5, SCREEN_HEIGHT - 58, 12, txtColor);
-        itemPosX += 200;
+        int y = (int)panel.y + 24 + (BATTLE_LOG_VISIBLE - 1) * BATTLE_LOG_LINE_HEIGHT;
+        for (int age = battleLogScroll; age < battleLogScroll + BATTLE_LOG_VISIBLE && age < count; age++)
+        {
+            const BattleLogEntry *entry = BattleLogRecent(&battleLog, age);
+            Color color = entry->actor == BATTLE_LOG_PLAYER ? (Color){150, 200, 255, 255}
+                          : entry->actor == BATTLE_LOG_BOSS ? (Color){255, 100, 100, 255}
+                                                            : LIGHTGRAY;
+            DrawText(TextFormat("%3d", entry->turn), (int)panel.x + 8, y, 12, GRAY);
+            DrawText(BattleLogFormat(entry, line, sizeof(line)), (int)panel.x + 40, y, 12, color);
+            y -= BATTLE_LOG_LINE_HEIGHT;
+        }
+        LayerEnd();
     }
+}
 
-    DrawRectangle(SCREEN_WIDTH - 150, SCREEN_HEIGHT - 85, 130, 45, RED);
-    DrawRectangleLines(SCREEN_WIDTH - 150, SCREEN_HEIGHT - 85, 130, 45, MAROON);
-    DrawText("ATACAR [A]", SCREEN_WIDTH - 140, SCREEN_HEIGHT - 75, 16, WHITE);
+/* View-only keys, read outside the simulation like F2 and F4. PageUp,
+   PageDown and the wheel scroll the log panel, which stays on the same lines
+   while scrolled back; L on an ending screen writes the log to
+   battleLogPath. */
+void UpdateBattleLogView(void)
+{
+    int count = BattleLogCount(&battleLog);
+    if (battleLogScroll > 0)
+        battleLogScroll += (int)(battleLog.total - battleLogSeen);
+    battleLogSeen = battleLog.total;
 
-    if (battleMessage)
+    if (currentState == GAME_STATE_BATTLE)
     {
-        DrawText(battleMessage, SCREEN_WIDTH / 2 - MeasureText(battleMessage, 20) / 2, 100, 20, YELLOW);
+        if (IsKeyPressed(KEY_PAGE_UP))
+            battleLogScroll += BATTLE_LOG_VISIBLE - 1;
+        if (IsKeyPressed(KEY_PAGE_DOWN))
+            battleLogScroll -= BATTLE_LOG_VISIBLE - 1;
+        battleLogScroll += (int)GetMouseWheelMove();
     }
+    if (battleLogScroll > count - BATTLE_LOG_VISIBLE)
+        battleLogScroll = count - BATTLE_LOG_VISIBLE;
+    if (battleLogScroll < 0)
+        battleLogScroll = 0;
+
+    bool ending = currentState == GAME_STATE_ENDING_GOOD || currentState == GAME_STATE_ENDING_BAD ||
+                  currentState == GAME_STATE_ENDING_ESCAPE;
+    if (ending && IsKeyPressed(KEY_L))
+    {
+        battleLogExported = BattleLogExport(&battleLog, battleLogPath);
+        if (!battleLogExported)
+            TraceLog(LOG_WARNING, "LOG: nao foi possivel gravar %s", battleLogPath);
+    }
+}
+
+/* Looks up the exact win chance of the battle state on screen. Rows the
+   table is missing are filled for at most WIN_ODDS_BUDGET per frame; that
+   starts as soon as the last item is picked, so the table is usually
+   complete before the battle begins. */
+void UpdateWinOdds(void)
+{
+    winOddsReady = false;
+    const EntityStore *e = &battleEntities;
+    int p = PlayerSlot(), b = BossSlot();
+    bool inBattle = currentState == GAME_STATE_BATTLE;
+    if (!inBattle && !(currentState == GAME_STATE_EXPLORE && inventoryCount == INVENTORY_SIZE))
+        return;
+    if (e->maxHp[p] != PLAYER_START_HP || e->attack[b] != BOSS_START_ATTACK || !OddsSetBuild(&winOdds, inventory))
+        return;
+
+    unsigned mask = 0;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        if (itemUsed[i])
+            mask |= 1u << i;
+    }
+    if (!OddsAdvance(&winOdds, e->hp[b], WIN_ODDS_BUDGET) || !inBattle)
+        return;
+    winOddsReady = OddsLookup(&winOdds, e->hp[p], e->hp[b], mask, playerHasArmor, battleState == BATTLE_PLAYER_TURN, &winChance,
+                              &winAction);
+}
+
+/* Redraws the cached HUD layers whose inputs changed since the last frame. */
+void UpdateHudLayers(void)
+{
+    if (currentState == GAME_STATE_EXPLORE)
+        UpdateExploreLayers();
+    else if (currentState == GAME_STATE_BATTLE)
+        UpdateBattleLayers();
+}
+
+void DrawBattleLogExportHint(void)
+{
+    if (battleLogExported)
+        DrawText(TextFormat("Registro da batalha salvo em %s", battleLogPath), 200, 540, 16, LIGHTGRAY);
+    else
+        DrawText("[L] salvar o registro da batalha", 200, 540, 16, LIGHTGRAY);
 }
 
 void DrawEnding(bool playerWon)
 {
-    ClearBackground((Color){20, 20, 40, 255});
     DrawRectangleLines(SCREEN_WIDTH / 2 - 400, SCREEN_HEIGHT / 2 - 200, 800, 400, BLUE);
 
     const char *title = playerWon ? "VITORIA!" : "GAME OVER";
     Color col = playerWon ? GREEN : RED;
     DrawText(title, SCREEN_WIDTH / 2 - MeasureText(title, 60) / 2, 200, 60, col);
-    DrawText("Pressione [ENTER] para jogar novamente.", 200, 500, 20, WHITE);
+    if (endlessMode)
+    {
+        int floor = currentStage / STAGE_COUNT;
+        const char *text = playerWon ? TextFormat("Andar %d concluido.", floor) : TextFormat("Voce caiu no andar %d.", floor);
+        DrawText(text, SCREEN_WIDTH / 2 - MeasureText(text, 20) / 2, 300, 20, WHITE);
+    }
+    DrawText(endlessMode && playerWon ? "Pressione [ENTER] para o proximo andar." : "Pressione [ENTER] para jogar novamente.", 200, 500,
+             20, WHITE);
+    DrawBattleLogExportHint();
 }
 
 void DrawEscapeEnding(void)
 {
-    ClearBackground((Color){20, 20, 40, 255});
     DrawText("FUGA!", SCREEN_WIDTH / 2 - MeasureText("FUGA!", 60) / 2, 200, 60, ORANGE);
     DrawText("Voce fugiu com sucesso.", SCREEN_WIDTH / 2 - 100, 300, 20, WHITE);
     DrawText("Pressione [ENTER] para jogar novamente.", 200, 500, 20, WHITE);
+    DrawBattleLogExportHint();
 }
 
 void DrawTitleScreen(void)
@@ -760,14 +1264,23 @@ void DrawTitleScreen(void)
     {
         ClearBackground((Color){10, 10, 30, 255});
     }
+}
 
+void DrawTitleHud(void)
+{
     DrawText("Rush RPG", SCREEN_WIDTH / 2 - MeasureText("RushRPG", 80) / 2, 100, 80, GOLD);
 
-    if (((int)(GetTime() * 2) % 2) == 0)
+    if (((int)(GetTime() * TITLE_BLINK_RATE) % 2) == 0)
     {
         DrawText("Pressione [ENTER] para comecar", SCREEN_WIDTH / 2 - MeasureText("Pressione [ENTER] para comecar", 30) / 2, SCREEN_HEIGHT - 100, 30, GREEN);
     }
 
+    if (endlessMode)
+    {
+        const char *text = TextFormat("Modo infinito - semente %llu", (unsigned long long)gameSeed);
+        DrawText(text, SCREEN_WIDTH / 2 - MeasureText(text, 20) / 2, 200, 20, LIGHTGRAY);
+    }
+
     const char *students[] = {"Lucas Del Pozo", "Lucas Sassi de Souza", "Eduardo Parize", "Vinicius Ribas Bida"};
     int namesY = SCREEN_HEIGHT - 180;
     DrawRectangle(SCREEN_WIDTH - 250, namesY - 10, 240, 150, (Color){0, 0, 0, 150});
@@ -776,70 +1289,350 @@ void DrawTitleScreen(void)
         DrawText(students[i], SCREEN_WIDTH - 240, namesY + 30 + (i * 20), 10, LIGHTGRAY);
 }
 
-int main(void)
+void UpdateGame(void)
 {
-    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Raylib RPG de Turnos");
-    InitGame();
-    SetTargetFPS(60);
+    ReplayBeginFrame(simStep);
+
+    switch (currentState)
+    {
+    case GAME_STATE_TITLE:
+        PROF_BEGIN(PROF_UPDATE_TITLE);
+        UpdateTitleScreen();
+        PROF_END(PROF_UPDATE_TITLE);
+        break;
+    case GAME_STATE_EXPLORE:
+        PROF_BEGIN(PROF_UPDATE_EXPLORE);
+        UpdateExplore();
+        PROF_END(PROF_UPDATE_EXPLORE);
+        break;
+    case GAME_STATE_BATTLE:
+        PROF_BEGIN(PROF_UPDATE_BATTLE);
+        UpdateBattle();
+        PROF_END(PROF_UPDATE_BATTLE);
+        break;
+    case GAME_STATE_ENDING_GOOD:
+    case GAME_STATE_ENDING_BAD:
+    case GAME_STATE_ENDING_ESCAPE:
+        PROF_BEGIN(PROF_UPDATE_ENDING);
+        if (InputKeyPressed(KEY_ENTER) && endlessMode && currentState == GAME_STATE_ENDING_GOOD)
+            StartNextFloor();
+        else if (InputKeyPressed(KEY_ENTER))
+            InitGame();
+        PROF_END(PROF_UPDATE_ENDING);
+        break;
+    }
+}
+
+/* count animated copies of the player and boss attack strips, scattered
+   over the screen with a fixed seed. */
+void DrawSpriteStress(int count, double time)
+{
+    ClearBackground((Color){20, 20, 40, 255});
+    Rng rng;
+    RngSeed(&rng, 1);
+    for (int i = 0; i < count; i++)
+    {
+        bool isBoss = (i & 1) != 0;
+        const AnimClip *clip = &clips[isBoss ? CLIP_BOSS_ATTACK : CLIP_PLAYER_ATTACK];
+        SpriteId id = isBoss ? SPRITE_BOSS : SPRITE_PLAYER;
+        Rectangle src = AtlasRect(id);
+        src.x = src.y = 0;
+        if (clip->sprite >= 0)
+        {
+            id = (SpriteId)clip->sprite;
+            src = clip->frames[((int)(time * 12.0) + i) % clip->frameCount];
+        }
+        float x = (float)RngRange(&rng, 0, SCREEN_WIDTH) + 20.0f * sinf((float)time + i * 0.1f);
+        float y = (float)RngRange(&rng, 0, SCREEN_HEIGHT);
+        Rectangle dest = {x, y, src.width * 0.25f, src.height * 0.25f};
+        SpriteBatchPush(id, src, dest, (Vector2){dest.width / 2, dest.height / 2}, WHITE, SPRITE_LAYER_ACTOR);
+    }
+    SpriteBatchFlush();
+}
+
+/* --stress: draws sprite crowds instead of the game and logs frame times. */
+void RunSpriteStress(int count)
+{
+    double windowStart = GetTime();
+    double worst = 0.0, total = 0.0;
+    int frames = 0;
 
     while (!WindowShouldClose())
     {
-        switch (currentState)
+        UpdateAssetStreaming();
+        double start = GetTime();
+        BeginDrawing();
+        if (spritesReady)
+            DrawSpriteStress(count, start);
+        else
+            ClearBackground(BLACK);
+        DrawRectangle(0, 0, 330, 30, BLACK);
+        DrawText(TextFormat("%d sprites  %.2f ms  %d FPS", count, GetFrameTime() * 1000.0f, GetFPS()), 8, 8, 16, GREEN);
+        EndDrawing();
+
+        double frameMs = (GetTime() - start) * 1000.0;
+        total += frameMs;
+        if (frameMs > worst)
+            worst = frameMs;
+        frames++;
+        if (GetTime() - windowStart >= 2.0)
         {
-        case GAME_STATE_TITLE:
-            UpdateTitleScreen();
-            break;
-        case GAME_STATE_EXPLORE:
-            UpdateExplore();
-            break;
-        case GAME_STATE_BATTLE:
-            UpdateBattle();
-            break;
-        case GAME_STATE_ENDING_GOOD:
-        case GAME_STATE_ENDING_BAD:
-        case GAME_STATE_ENDING_ESCAPE:
-            if (IsKeyPressed(KEY_ENTER))
-                InitGame();
-            break;
+            TraceLog(LOG_INFO, "STRESS: %d sprites, media %.2f ms, pior %.2f ms em %d quadros", count, total / frames, worst, frames);
+            windowStart = GetTime();
+            worst = total = 0.0;
+            frames = 0;
         }
+    }
+}
+
+/* Tops the pool up to about count particles with bursts of the three battle
+   effects at random spots. */
+void FeedParticleStress(ParticlePool *pool, int count)
+{
+    const ParticleEmitter *emitters[3] = {&sparkEmitter, &bombEmitter, &healEmitter};
+    for (int k = 0; pool->count < count && pool->count < PARTICLE_MAX; k++)
+    {
+        float x = ParticleRandom(&pool->rng, 0.0f, SCREEN_WIDTH);
+        float y = ParticleRandom(&pool->rng, 0.0f, SCREEN_HEIGHT);
+        ParticleEmit(pool, emitters[k % 3], x, y);
+    }
+}
+
+/* --particles: keeps count particles alive instead of the game and logs the
+   average particles per frame next to the frame times. */
+void RunParticleStress(int count)
+{
+    double windowStart = GetTime();
+    double worst = 0.0, total = 0.0;
+    long long particles = 0;
+    int frames = 0;
+    ParticlePoolClear(&battleParticles, 1);
+
+    while (!WindowShouldClose())
+    {
+        double start = GetTime();
+        float dt = GetFrameTime();
+        if (dt > SIM_MAX_FRAME_TIME)
+            dt = SIM_MAX_FRAME_TIME;
+        FeedParticleStress(&battleParticles, count);
+        ParticleUpdate(&battleParticles, dt, SCREEN_WIDTH, SCREEN_HEIGHT);
 
         BeginDrawing();
-        switch (currentState)
+        ClearBackground((Color){20, 20, 40, 255});
+        ParticleDraw(&battleParticles);
+        DrawRectangle(0, 0, 360, 30, BLACK);
+        DrawText(TextFormat("%d particulas  %.2f ms  %d FPS", battleParticles.count, GetFrameTime() * 1000.0f, GetFPS()), 8, 8, 16, GREEN);
+        EndDrawing();
+
+        double frameMs = (GetTime() - start) * 1000.0;
+        total += frameMs;
+        if (frameMs > worst)
+            worst = frameMs;
+        particles += battleParticles.count;
+        frames++;
+        if (GetTime() - windowStart >= 2.0)
         {
-        case GAME_STATE_TITLE:
-            DrawTitleScreen();
-            break;
-        case GAME_STATE_EXPLORE:
-            DrawExplore();
-            break;
-        case GAME_STATE_BATTLE:
-            DrawBattle();
-            break;
-        case GAME_STATE_ENDING_GOOD:
-            DrawEnding(true);
-            break;
-        case GAME_STATE_ENDING_BAD:
-            DrawEnding(false);
-            break;
-        case GAME_STATE_ENDING_ESCAPE:
-            DrawEscapeEnding();
-            break;
+            TraceLog(LOG_INFO, "PARTICULAS: %lld por quadro, media %.2f ms, pior %.2f ms em %d quadros", particles / frames, total / frames,
+                     worst, frames);
+            windowStart = GetTime();
+            worst = total = 0.0;
+            particles = 0;
+            frames = 0;
+        }
+    }
+}
+
+/* The title and ending screens only change on input, at the title's blink
+   or when a streamed texture lands. Returns true when the last drawn frame
+   is still valid and sets *deadline to when it stops being so. */
+bool ScreenIsStatic(double *deadline)
+{
+    if (ReplayIsPlaying() || PROF_WANTS_FRAMES() || !spritesReady || StreamIsBusy())
+        return false;
+
+    switch (currentState)
+    {
+    case GAME_STATE_TITLE:
+        *deadline = (floor(GetTime() * TITLE_BLINK_RATE) + 1.0) / TITLE_BLINK_RATE;
+        return true;
+    case GAME_STATE_ENDING_GOOD:
+    case GAME_STATE_ENDING_BAD:
+    case GAME_STATE_ENDING_ESCAPE:
+        *deadline = IDLE_NO_DEADLINE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Both passes add to the same per-screen profiler phase. */
+void DrawScene(void)
+{
+    switch (currentState)
+    {
+    case GAME_STATE_TITLE:
+        PROF_BEGIN(PROF_DRAW_TITLE);
+        DrawTitleScreen();
+        PROF_END(PROF_DRAW_TITLE);
+        break;
+    case GAME_STATE_EXPLORE:
+        PROF_BEGIN(PROF_DRAW_EXPLORE);
+        DrawExplore();
+        PROF_END(PROF_DRAW_EXPLORE);
+        break;
+    case GAME_STATE_BATTLE:
+        PROF_BEGIN(PROF_DRAW_BATTLE);
+        DrawBattle();
+        PROF_END(PROF_DRAW_BATTLE);
+        break;
+    case GAME_STATE_ENDING_GOOD:
+    case GAME_STATE_ENDING_BAD:
+    case GAME_STATE_ENDING_ESCAPE:
+        ClearBackground((Color){20, 20, 40, 255});
+        break;
+    }
+}
+
+void DrawHud(void)
+{
+    switch (currentState)
+    {
+    case GAME_STATE_TITLE:
+        PROF_BEGIN(PROF_DRAW_TITLE);
+        DrawTitleHud();
+        PROF_END(PROF_DRAW_TITLE);
+        break;
+    case GAME_STATE_EXPLORE:
+        PROF_BEGIN(PROF_DRAW_EXPLORE);
+        DrawExploreHud();
+        PROF_END(PROF_DRAW_EXPLORE);
+        break;
+    case GAME_STATE_BATTLE:
+        PROF_BEGIN(PROF_DRAW_BATTLE);
+        DrawBattleHud();
+        PROF_END(PROF_DRAW_BATTLE);
+        break;
+    case GAME_STATE_ENDING_GOOD:
+    case GAME_STATE_ENDING_BAD:
+        PROF_BEGIN(PROF_DRAW_ENDING);
+        DrawEnding(currentState == GAME_STATE_ENDING_GOOD);
+        PROF_END(PROF_DRAW_ENDING);
+        break;
+    case GAME_STATE_ENDING_ESCAPE:
+        PROF_BEGIN(PROF_DRAW_ENDING);
+        DrawEscapeEnding();
+        PROF_END(PROF_DRAW_ENDING);
+        break;
+    }
+}
+
+/* Window pixels, top right; toggled with F4. */
+void DrawResScaleStats(void)
+{
+    const ResScale *rs = &resScale;
+    const char *text = TextFormat("escala %.0f%% (%dx%d)  %s %.2f ms  alvo %.2f ms", rs->scale * 100.0f, rs->target.texture.width,
+                                  rs->target.texture.height, rs->gpuTimer ? "GPU" : "CPU", rs->gpuMs, rs->budgetMs);
+    int width = MeasureText(text, 10);
+    DrawRectangle(GetScreenWidth() - width - 20, 5, width + 15, 20, (Color){0, 0, 0, 200});
+    DrawText(text, GetScreenWidth() - width - 12, 10, 10, rs->fixed ? LIGHTGRAY : GREEN);
+}
+
+/* Everything a displayed frame does besides advancing the simulation. The
+   scene goes through the dynamic-resolution target; HUD layers and text are
+   drawn afterwards at the window's resolution. */
+void RenderFrame(void)
+{
+    PROF_BEGIN(PROF_ASSETS_STREAM);
+    UpdateAssetStreaming();
+    PROF_END(PROF_ASSETS_STREAM);
+    if (IsKeyPressed(KEY_F2))
+        TexMgrReport();
+    if (IsKeyPressed(KEY_F4))
+        resScaleStatsVisible = !resScaleStatsVisible;
+    UpdateBattleLogView();
+    PROF_BEGIN(PROF_WIN_ODDS);
+    UpdateWinOdds();
+    PROF_END(PROF_WIN_ODDS);
+
+    ResScaleFrameBegin(&resScale);
+    layerPixelScale = ResScaleOutput(&resScale);
+    PROF_BEGIN(PROF_HUD_LAYERS);
+    UpdateHudLayers();
+    PROF_END(PROF_HUD_LAYERS);
+
+    ResScaleBeginScene(&resScale);
+    DrawScene();
+    ResScaleEndScene();
+
+    BeginDrawing();
+    ResScaleBeginHud(&resScale);
+    DrawHud();
+    ResScaleEndHud();
+
+    PROF_DRAW_OVERLAY();
+    if (resScaleStatsVisible)
+        DrawResScaleStats();
+    ResScaleFrameEnd(&resScale);
+    PROF_BEGIN(PROF_PRESENT);
+    EndDrawing();
+    PROF_END(PROF_PRESENT);
+}
+
+/* --spectate: draws the battle another process broadcasts, without running
+   any game logic. */
+void RunSpectator(const char *name)
+{
+    SpectateReader reader;
+    if (!SpectateReaderOpen(&reader, name))
+    {
+        TraceLog(LOG_WARNING, "SPECTATE: nenhuma transmissao em %s", name);
+        return;
+    }
+
+    SpectateState state;
+    memset(&state, 0, sizeof(state));
+    while (!WindowShouldClose())
+    {
+        if (SpectatePoll(&reader, &state) > 0)
+        {
+            ApplySpectateState(&state);
+            renderPrev = CaptureRenderState();
+            renderAlpha = 1.0f;
         }
+
+        bool live = reader.synced && currentState != GAME_STATE_TITLE && currentState != GAME_STATE_EXPLORE;
+        if (live)
+        {
+            RenderFrame();
+            continue;
+        }
+        UpdateAssetStreaming();
+        BeginDrawing();
+        ClearBackground((Color){20, 20, 40, 255});
+        const char *text = "Aguardando a batalha...";
+        DrawText(text, SCREEN_WIDTH / 2 - MeasureText(text, 30) / 2, SCREEN_HEIGHT / 2 - 15, 30, LIGHTGRAY);
         EndDrawing();
     }
+    SpectateReaderClose(&reader);
+}
 
-    if (playerTexture.id)
-        UnloadTexture(playerTexture);
-    if (bossTexture.id)
-        UnloadTexture(bossTexture);
+void UnloadGame(void)
+{
+    StreamShutdown();
+    AtlasUnload();
+    LayerUnload(&exploreStoryLayer);
+    LayerUnload(&exploreDoorLayers[0]);
+    LayerUnload(&exploreDoorLayers[1]);
+    LayerUnload(&exploreHintLayer);
+    LayerUnload(&itemMessageLayer);
+    LayerUnload(&battleBarsLayer);
+    LayerUnload(&battleItemsLayer);
+    LayerUnload(&battleTextLayer);
+    LayerUnload(&battleLogLayer);
     if (titleBackgroundTexture.id)
         UnloadTexture(titleBackgroundTexture);
     if (battleBackgroundTexture.id)
         UnloadTexture(battleBackgroundTexture);
-    if (bossAttackTexture.id)
-        UnloadTexture(bossAttackTexture);
-    if (playerAttackTexture.id)
-        UnloadTexture(playerAttackTexture);
 
     if (bgStage1.id)
         UnloadTexture(bgStage1);
@@ -849,7 +1642,440 @@ int main(void)
         UnloadTexture(bgStage3);
     if (bgStage4.id)
         UnloadTexture(bgStage4);
+    if (endlessBackground.id)
+        UnloadTexture(endlessBackground);
+    StageGenShutdown();
+    ResScaleUnload(&resScale);
+
+    PackClose();
+    OddsFree(&winOdds);
+    ReplayStop();
+    PROF_CLOSE_CSV();
+}
+
+#ifdef RUSH_BENCH
+#define BENCH_HOLD_STEPS 120
+#define BENCH_MAX_STEPS 20000
+
+/* A scripted playthrough: the door taken in each stage, the inventory slots
+   used in battle (ACTION_ATTACK for the attack button, the last entry
+   repeats) and the ending it must reach with its seed. */
+typedef struct
+{
+    const char *name;
+    uint64_t seed;
+    int doors[STAGE_COUNT];
+    int actions[INVENTORY_SIZE];
+    int actionCount;
+    GameState ending;
+} BenchScenario;
+
+static const BenchScenario benchScenarios[] = {
+    {"vitoria", 7, {0, 0, 0, 0}, {2, ACTION_ATTACK}, 2, GAME_STATE_ENDING_GOOD},
+    {"derrota", 1, {0, 1, 1, 0}, {ACTION_ATTACK}, 1, GAME_STATE_ENDING_BAD},
+    {"fuga", 3, {0, 1, 1, 0}, {2}, 1, GAME_STATE_ENDING_ESCAPE},
+};
+#define BENCH_SCENARIO_COUNT ((int)(sizeof(benchScenarios) / sizeof(benchScenarios[0])))
+
+/* Picks the keys for the next step from the scenario and the game state. */
+void BenchScriptStep(const BenchScenario *sc, int *nextAction, int step)
+{
+    uint8_t down = 0, pressed = 0;
+
+    if (currentState == GAME_STATE_TITLE)
+    {
+        if (step >= BENCH_HOLD_STEPS)
+            pressed = ReplayKeyBit(KEY_ENTER);
+    }
+    else if (currentState == GAME_STATE_EXPLORE && itemMessageTimer <= 0 && currentStage < STAGE_COUNT)
+    {
+        Rectangle playerRect = (Rectangle){explorePlayerX - 5, explorePlayerY - 10, 30, 60};
+        Rectangle door = sc->doors[currentStage] == 0 ? doorLeftRect : doorRightRect;
+        if (CheckCollisionRecs(playerRect, door))
+            pressed = ReplayKeyBit(KEY_ENTER);
+        else
+            down = ReplayKeyBit(sc->doors[currentStage] == 0 ? KEY_LEFT : KEY_RIGHT);
+    }
+    else if (currentState == GAME_STATE_BATTLE && battleState == BATTLE_PLAYER_TURN &&
+             !EntityIsAttacking(&battleEntities, PlayerSlot()) && !EntityIsAttacking(&battleEntities, BossSlot()))
+    {
+        int action = sc->actions[*nextAction < sc->actionCount ? *nextAction : sc->actionCount - 1];
+        if (action == ACTION_ATTACK)
+        {
+            pressed = ReplayKeyBit(KEY_A);
+            (*nextAction)++;
+        }
+        else if (selectedItemIndex != action)
+        {
+            pressed = ReplayKeyBit(KEY_RIGHT);
+        }
+        else
+        {
+            pressed = ReplayKeyBit(KEY_ENTER);
+            (*nextAction)++;
+        }
+    }
+
+    ReplayScriptInput(down, pressed);
+}
+
+bool BenchRunScenario(const BenchScenario *sc, BenchResult *result)
+{
+    RngSeed(&combatRng, sc->seed);
+    InitGame();
+    renderPrev = CaptureRenderState();
+    renderAlpha = 1.0f;
+
+    int nextAction = 0;
+    int endingSteps = 0;
+    BenchStart();
+    for (int step = 0; step < BENCH_MAX_STEPS && endingSteps < BENCH_HOLD_STEPS; step++)
+    {
+        double start = BenchClockMs();
+        BenchScriptStep(sc, &nextAction, step);
+        renderPrev = CaptureRenderState();
+        UpdateGame();
+        RenderFrame();
+        BenchRecord(BenchClockMs() - start);
+
+        if (currentState == GAME_STATE_ENDING_GOOD || currentState == GAME_STATE_ENDING_BAD ||
+            currentState == GAME_STATE_ENDING_ESCAPE)
+            endingSteps++;
+    }
+    *result = BenchFinish(sc->name);
+
+    if (currentState != sc->ending)
+    {
+        fprintf(stderr, "Cenario %s terminou no estado %d, esperado %d\n", sc->name, currentState, sc->ending);
+        return false;
+    }
+    return true;
+}
+
+/* Ticks a horde-sized store on its own; one sample per simulation step. */
+BenchResult BenchRunEntities(int count, int steps)
+{
+    static EntityStore horde;
+    Rng rng;
+    RngSeed(&rng, 1);
+    EntityStoreClear(&horde, clips);
+    for (int i = 0; i < count; i++)
+    {
+        int slot = EntityIndex(&horde, EntityCreate(&horde, BOSS_START_HP, BOSS_START_ATTACK));
+        EntitySetClips(&horde, slot, CLIP_BOSS_ATTACK, CLIP_BOSS_HURT);
+    }
+
+    BenchStart();
+    for (int step = 0; step < steps; step++)
+    {
+        double start = BenchClockMs();
+        for (int k = 0; k < count / 64; k++)
+        {
+            int slot = RngRange(&rng, 0, count - 1);
+            EntityStartAttack(&horde, slot);
+            EntityHurt(&horde, slot);
+        }
+        EntityTick(&horde, simStep);
+        BenchRecord(BenchClockMs() - start);
+    }
+    return BenchFinish(TextFormat("entidades_%dk", count / 1000));
+}
+
+BenchResult BenchRunSprites(int count, int frames)
+{
+    for (int i = 0; i < 600 && !spritesReady; i++)
+        UpdateAssetStreaming();
+
+    BenchStart();
+    for (int f = 0; f < frames; f++)
+    {
+        double start = BenchClockMs();
+        BeginDrawing();
+        DrawSpriteStress(count, f * simStep);
+        EndDrawing();
+        BenchRecord(BenchClockMs() - start);
+    }
+    return BenchFinish(TextFormat("sprites_%dk", count / 1000));
+}
+
+BenchResult BenchRunParticles(int count, int frames)
+{
+    ParticlePoolClear(&battleParticles, 1);
+    BenchStart();
+    for (int f = 0; f < frames; f++)
+    {
+        double start = BenchClockMs();
+        FeedParticleStress(&battleParticles, count);
+        ParticleUpdate(&battleParticles, simStep, SCREEN_WIDTH, SCREEN_HEIGHT);
+        BeginDrawing();
+        ParticleDraw(&battleParticles);
+        EndDrawing();
+        BenchRecord(BenchClockMs() - start);
+    }
+    return BenchFinish(TextFormat("particulas_%dk", count / 1000));
+}
+
+/* One full stage (text, items and background) per sample, on this thread. */
+BenchResult BenchRunStages(int count)
+{
+    BenchStart();
+    for (int i = 0; i < count; i++)
+    {
+        double start = BenchClockMs();
+        GeneratedStage stage;
+        StageGenerate(&stage, 1, i);
+        BenchRecord(BenchClockMs() - start);
+        UnloadImage(stage.background);
+    }
+    return BenchFinish("fases_geradas");
+}
+
+int BenchMain(int argc, char **argv)
+{
+    const char *baselinePath = BENCH_DEFAULT_BASELINE;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    bool saveBaseline = false;
 
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--save-baseline") == 0)
+            saveBaseline = true;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Rush RPG benchmark");
+    SetTargetFPS(0);
+    ResScaleInit(&resScale, SCREEN_WIDTH, SCREEN_HEIGHT, 0.0f);
+    ResScaleFix(&resScale, 1.0f);
+    PackOpen(PACK_DEFAULT_PATH);
+
+    BenchResult results[BENCH_MAX_SCENARIOS];
+    bool scriptsOk = true;
+    int resultCount = 0;
+    for (int i = 0; i < BENCH_SCENARIO_COUNT; i++)
+        scriptsOk = BenchRunScenario(&benchScenarios[i], &results[resultCount++]) && scriptsOk;
+    results[resultCount++] = BenchRunEntities(10000, 2000);
+    results[resultCount++] = BenchRunSprites(STRESS_DEFAULT_COUNT, 300);
+    results[resultCount++] = BenchRunParticles(PARTICLE_STRESS_DEFAULT_COUNT, 300);
+    results[resultCount++] = BenchRunStages(200);
+
+    UnloadGame();
+    CloseWindow();
+
+    BenchResult baseline[BENCH_MAX_SCENARIOS];
+    int baselineCount = BenchLoadBaseline(baselinePath, baseline, BENCH_MAX_SCENARIOS);
+    int regressions = BenchReport(results, resultCount, baseline, baselineCount, threshold);
+
+    if (saveBaseline)
+    {
+        if (!BenchSaveBaseline(baselinePath, results, resultCount))
+        {
+            fprintf(stderr, "Erro ao salvar %s\n", baselinePath);
+            return 1;
+        }
+        printf("Referencia salva em %s\n", baselinePath);
+        return scriptsOk ? 0 : 1;
+    }
+    if (baselineCount == 0)
+        printf("Sem referencia em %s; rode com --save-baseline para criar.\n", baselinePath);
+    else if (regressions > 0)
+        printf("%d cenario(s) acima do limite de %.0f%%.\n", regressions, threshold * 100.0);
+    return (scriptsOk && regressions == 0) ? 0 : 1;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+#ifdef RUSH_BENCH
+    return BenchMain(argc, argv);
+#endif
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    int replaySpeed = 1;
+    int tickRate = SIM_DEFAULT_HZ;
+    int targetFps = 0;
+    int stressCount = 0;
+    int particleCount = 0;
+    float frameBudgetMs = 0.0f;
+    float fixedResScale = 0.0f;
+    const char *resumePath = NULL;
+    const char *broadcastName = NULL;
+    const char *spectateName = NULL;
+    bool exportBattleLog = false;
+    bool seedGiven = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            gameSeed = strtoull(argv[++i], NULL, 10);
+            seedGiven = true;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            replaySpeed = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tick-hz") == 0 && i + 1 < argc)
+            tickRate = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            targetFps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stress") == 0)
+            stressCount = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : STRESS_DEFAULT_COUNT;
+        else if (strcmp(argv[i], "--particles") == 0)
+            particleCount = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : PARTICLE_STRESS_DEFAULT_COUNT;
+        else if (strcmp(argv[i], "--frame-budget-ms") == 0 && i + 1 < argc)
+            frameBudgetMs = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--res-scale") == 0 && i + 1 < argc)
+            fixedResScale = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--battle-log") == 0 && i + 1 < argc)
+        {
+            battleLogPath = argv[++i];
+            exportBattleLog = true;
+        }
+        else if (strcmp(argv[i], "--endless") == 0)
+            endlessMode = true;
+        else if (strcmp(argv[i], "--resume") == 0)
+            resumePath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : SAVE_DEFAULT_PATH;
+        else if (strcmp(argv[i], "--broadcast") == 0)
+            broadcastName = (i + 1 < argc && argv[i + 1][0] == '/') ? argv[++i] : SPECTATE_DEFAULT_NAME;
+        else if (strcmp(argv[i], "--spectate") == 0)
+            spectateName = (i + 1 < argc && argv[i + 1][0] == '/') ? argv[++i] : SPECTATE_DEFAULT_NAME;
+        else if (strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc)
+            PROF_OPEN_CSV(argv[++i]);
+        else if (strcmp(argv[i], "--vram-mb") == 0 && i + 1 < argc)
+            TexMgrSetBudget((size_t)atoi(argv[++i]) * 1024u * 1024u);
+    }
+    if (!seedGiven)
+        gameSeed = (uint64_t)time(NULL);
+    if (replaySpeed < 1)
+        replaySpeed = 1;
+    if (replaySpeed > REPLAY_MAX_SPEED)
+        replaySpeed = REPLAY_MAX_SPEED;
+    if (tickRate < 30)
+        tickRate = 30;
+    if (tickRate > 1000)
+        tickRate = 1000;
+    simStep = 1.0f / tickRate;
+
+    if (targetFps <= 0 && stressCount == 0 && particleCount == 0)
+        SetConfigFlags(FLAG_VSYNC_HINT);
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Raylib RPG de Turnos");
+
+    if (frameBudgetMs <= 0.0f)
+    {
+        int hz = targetFps > 0 ? targetFps : GetMonitorRefreshRate(GetCurrentMonitor());
+        frameBudgetMs = 1000.0f / (hz > 0 ? hz : 60);
+    }
+    ResScaleInit(&resScale, SCREEN_WIDTH, SCREEN_HEIGHT, frameBudgetMs);
+    if (fixedResScale > 0.0f)
+        ResScaleFix(&resScale, fixedResScale);
+
+    uint8_t replayFlags = endlessMode ? REPLAY_FLAG_ENDLESS : 0;
+    if (replayPath && !ReplayStartPlayback(replayPath, &gameSeed, &replayFlags))
+        TraceLog(LOG_WARNING, "REPLAY: nao foi possivel abrir %s", replayPath);
+    else if (!replayPath && recordPath && !ReplayStartRecording(recordPath, gameSeed, replayFlags))
+        TraceLog(LOG_WARNING, "REPLAY: nao foi possivel gravar em %s", recordPath);
+
+    if (!PackOpen(PACK_DEFAULT_PATH))
+        TraceLog(LOG_INFO, "PACK: %s ausente, usando arquivos soltos", PACK_DEFAULT_PATH);
+
+    if (resumePath && ReplayIsActive())
+    {
+        TraceLog(LOG_WARNING, "SAVE: --resume ignorado durante gravacao ou reproducao de replay");
+        resumePath = NULL;
+    }
+
+    if (ReplayIsPlaying())
+        endlessMode = (replayFlags & REPLAY_FLAG_ENDLESS) != 0;
+
+    RngSeed(&combatRng, gameSeed);
+    InitGame();
+    if (resumePath && LoadGame(resumePath))
+        TraceLog(LOG_INFO, "SAVE: partida retomada de %s", resumePath);
+    renderPrev = CaptureRenderState();
+    if (targetFps > 0)
+        SetTargetFPS(targetFps);
+
+    if (stressCount > 0 || particleCount > 0 || spectateName)
+    {
+        if (spectateName)
+            RunSpectator(spectateName);
+        else if (particleCount > 0)
+            RunParticleStress(particleCount);
+        else
+            RunSpriteStress(stressCount);
+        UnloadGame();
+        CloseWindow();
+        return 0;
+    }
+
+    if (broadcastName && !SpectatePublisherOpen(&spectatePublisher, broadcastName))
+        TraceLog(LOG_WARNING, "SPECTATE: nao foi possivel transmitir em %s", broadcastName);
+
+    /* Game logic advances in fixed steps of simStep; rendering runs at
+       whatever rate the display allows and interpolates between the last
+       two steps. Replays play back faster by feeding more time per frame.
+       Static screens are not redrawn until IdleWait says they may change; the
+       frame after a wait and the one after it (whose measured time includes
+       the wait) advance a single step. */
+    double accumulator = 0.0;
+    bool idled = false;
+    while (!WindowShouldClose())
+    {
+        bool resumed = idled;
+        double deadline;
+        idled = ScreenIsStatic(&deadline);
+        if (idled)
+        {
+            IdleWait(deadline);
+            if (WindowShouldClose())
+                break;
+        }
+
+        PROF_FRAME_BEGIN();
+        double frameTime = (idled || resumed) ? simStep : GetFrameTime();
+        if (frameTime > SIM_MAX_FRAME_TIME)
+            frameTime = SIM_MAX_FRAME_TIME;
+        accumulator += ReplayIsPlaying() ? frameTime * replaySpeed : frameTime;
+
+        ReplayPollInput();
+        while (accumulator >= simStep)
+        {
+            bool wasPlaying = ReplayIsPlaying();
+            renderPrev = CaptureRenderState();
+            UpdateGame();
+            if (spectatePublisher.ring)
+                BroadcastSpectators();
+            accumulator -= simStep;
+            if (wasPlaying && !ReplayIsPlaying())
+                accumulator = 0.0;
+        }
+        renderAlpha = (float)(accumulator / simStep);
+
+        RenderFrame();
+        PROF_FRAME_END();
+    }
+
+    if (resumePath && !SaveGame(resumePath))
+        TraceLog(LOG_WARNING, "SAVE: nao foi possivel gravar %s", resumePath);
+    if (exportBattleLog && !BattleLogExport(&battleLog, battleLogPath))
+        TraceLog(LOG_WARNING, "LOG: nao foi possivel gravar %s", battleLogPath);
+    if (spectatePublisher.ring)
+    {
+        TraceLog(LOG_INFO, "SPECTATE: %llu registros (%llu quadros-chave), media de %.1f bytes", (unsigned long long)spectatePublisher.records,
+                 (unsigned long long)spectatePublisher.keyframes,
+                 spectatePublisher.records ? (double)spectatePublisher.bytes / spectatePublisher.records : 0.0);
+        SpectatePublisherClose(&spectatePublisher);
+    }
+    UnloadGame();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
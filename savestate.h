@@ -0,0 +1,147 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "combat.h"
+#include "battlelog.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SAVE_MAGIC "RRSV"
+#define SAVE_VERSION 2
+#define SAVE_DEFAULT_PATH "rush_rpg.rrsv"
+
+/* One file is one SaveState, written as-is (little-endian, no padding: every
+   field is 4 or 8 bytes wide or a byte array sized to keep the alignment).
+   The header's size and checksum reject files from another layout or a torn
+   write; bump SAVE_VERSION whenever a field changes. */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t checksum;
+} SaveHeader;
+
+typedef struct
+{
+    int32_t hp;
+    int32_t maxHp;
+    int32_t attack;
+    int32_t attackFrame;
+    float attackTimer;
+    float attackFrameTime;
+    float hurtTimer;
+    uint32_t reserved;
+} SaveCombatant;
+
+typedef struct
+{
+    SaveHeader header;
+    uint64_t seed;
+    uint64_t rng[4];
+    uint32_t gameState;
+    uint32_t battleState;
+    int32_t currentStage;
+    int32_t inventoryCount;
+    int32_t selectedItemIndex;
+    int32_t lastItemCollected;
+    uint8_t inventory[INVENTORY_SIZE];
+    uint8_t itemUsed[INVENTORY_SIZE];
+    uint8_t playerHasArmor;
+    uint8_t endless;
+    uint8_t reserved[2];
+    float itemMessageTimer;
+    float bossTurnTimer;
+    float explorePlayerX;
+    float explorePlayerY;
+    SaveCombatant player;
+    SaveCombatant boss;
+    uint32_t logTotal;
+    int32_t logTurn;
+    BattleLogEntry log[BATTLE_LOG_CAPACITY];
+} SaveState;
+
+/* FNV-1a over everything after the header. */
+static inline uint32_t SaveChecksum(const SaveState *state)
+{
+    const uint8_t *p = (const uint8_t *)state + sizeof(SaveHeader);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(SaveState) - sizeof(SaveHeader); i++)
+        hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+/* Writes to path.tmp and renames over path, so a crash mid-write leaves the
+   previous save intact. Fills in the header. */
+static inline bool SaveStateWrite(const char *path, SaveState *state)
+{
+    memcpy(state->header.magic, SAVE_MAGIC, 4);
+    state->header.version = SAVE_VERSION;
+    state->header.size = (uint32_t)sizeof(SaveState);
+    state->header.checksum = SaveChecksum(state);
+
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *f = fopen(tmpPath, "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(state, sizeof(SaveState), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+    {
+        remove(tmpPath);
+        return false;
+    }
+#ifdef _WIN32
+    remove(path);
+#endif
+    return rename(tmpPath, path) == 0;
+}
+
+static inline bool SaveStateValid(const SaveState *state)
+{
+    return memcmp(state->header.magic, SAVE_MAGIC, 4) == 0 && state->header.version == SAVE_VERSION &&
+           state->header.size == sizeof(SaveState) && state->header.checksum == SaveChecksum(state);
+}
+
+static inline bool SaveStateRead(const char *path, SaveState *state)
+{
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(SaveState))
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, sizeof(SaveState), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    memcpy(state, data, sizeof(SaveState));
+    munmap(data, sizeof(SaveState));
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    bool read = fread(state, sizeof(SaveState), 1, f) == 1;
+    fclose(f);
+    if (!read)
+        return false;
+#endif
+    return SaveStateValid(state);
+}
+
+#endif
@@ -0,0 +1,415 @@
+#include "combat.h"
+#include "netproto.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_WORKERS 64
+#define MAX_EVENTS 256
+#define SESSION_BATCH 64
+#define STATS_INTERVAL 5.0
+
+/* One connected client. A session belongs to the worker that accepted it,
+   so its battle is only ever touched by one thread. */
+typedef struct
+{
+    int fd;
+    bool active;
+    bool writing;
+    Battle battle;
+    Rng rng;
+    uint8_t in[sizeof(NetRequest) * SESSION_BATCH];
+    int inLen;
+    uint8_t out[sizeof(NetResponse) * SESSION_BATCH];
+    int outLen;
+    int outSent;
+} Session;
+
+/* Counters are written by their worker and read by the stats loop. */
+typedef struct
+{
+    int id;
+    int epollFd;
+    Rng rng;
+    long long turns;
+    long long battles;
+    long long sessions;
+} __attribute__((aligned(64))) Worker;
+
+static Worker workers[MAX_WORKERS];
+static int workerCount;
+static int listenFd = -1;
+static bool listenTcp = false;
+static volatile sig_atomic_t running = 1;
+
+static void OnSignal(int sig)
+{
+    (void)sig;
+    running = 0;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int Listen(const char *path, int port)
+{
+    int fd;
+    if (port > 0)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    else
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        unlink(path);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, SOMAXCONN) != 0 || !NetSetNonBlocking(fd))
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool ValidInventory(const uint8_t inventory[INVENTORY_SIZE])
+{
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+    {
+        if (inventory[i] > ITEM_ARMOR)
+            return false;
+    }
+    return true;
+}
+
+/* The game's turn: the player's action and, unless that ended the battle or
+   did not spend the turn, the boss's attack. */
+static void ServeRequest(Worker *w, Session *s, const NetRequest *req, NetResponse *res)
+{
+    memset(res, 0, sizeof(*res));
+    Battle *b = &s->battle;
+
+    if (req->type == NET_REQ_START && ValidInventory(req->inventory))
+    {
+        ItemType inventory[INVENTORY_SIZE];
+        for (int i = 0; i < INVENTORY_SIZE; i++)
+            inventory[i] = (ItemType)req->inventory[i];
+        BattleInit(b, inventory);
+        RngSeed(&s->rng, req->seed ? req->seed : RngNext(&w->rng));
+        s->active = true;
+        res->status = NET_OK;
+    }
+    else if (req->type == NET_REQ_ACT)
+    {
+        if (!s->active || b->outcome != BATTLE_ONGOING)
+            res->status = NET_NO_BATTLE;
+        else if (req->action != ACTION_ATTACK && (req->action < 0 || req->action >= INVENTORY_SIZE))
+            res->status = NET_BAD_REQUEST;
+        else
+        {
+            int bossHp = b->bossHp, playerHp = b->playerHp;
+            if (!BattlePlayerAct(b, req->action, &s->rng))
+                res->status = NET_TURN_NOT_SPENT;
+            else
+            {
+                if (b->outcome == BATTLE_ONGOING)
+                    BattleBossAct(b, &s->rng);
+                __atomic_fetch_add(&w->turns, 1, __ATOMIC_RELAXED);
+                if (b->outcome != BATTLE_ONGOING)
+                    __atomic_fetch_add(&w->battles, 1, __ATOMIC_RELAXED);
+                res->status = NET_OK;
+            }
+            res->damageDealt = (int16_t)(bossHp - b->bossHp);
+            res->damageTaken = (int16_t)(playerHp > b->playerHp ? playerHp - b->playerHp : 0);
+        }
+    }
+    else
+    {
+        res->status = NET_BAD_REQUEST;
+    }
+
+    if (s->active)
+    {
+        res->outcome = (uint8_t)b->outcome;
+        res->itemUsed = b->itemUsed;
+        res->playerHasArmor = b->playerHasArmor ? 1 : 0;
+        res->playerHp = (int16_t)b->playerHp;
+        res->bossHp = (int16_t)b->bossHp;
+        res->turns = (uint32_t)b->turns;
+    }
+}
+
+static void CloseSession(Worker *w, Session *s)
+{
+    epoll_ctl(w->epollFd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    free(s);
+    __atomic_fetch_sub(&w->sessions, 1, __ATOMIC_RELAXED);
+}
+
+static bool WatchWrites(Worker *w, Session *s, bool writing)
+{
+    if (s->writing == writing)
+        return true;
+    struct epoll_event ev;
+    ev.events = writing ? EPOLLOUT : EPOLLIN;
+    ev.data.ptr = s;
+    s->writing = writing;
+    return epoll_ctl(w->epollFd, EPOLL_CTL_MOD, s->fd, &ev) == 0;
+}
+
+/* Sends what is queued. While a reply is stuck in the socket the session
+   stops reading, so a slow client cannot grow the server's buffers. */
+static bool FlushSession(Worker *w, Session *s)
+{
+    while (s->outSent < s->outLen)
+    {
+        ssize_t n = send(s->fd, s->out + s->outSent, (size_t)(s->outLen - s->outSent), MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return WatchWrites(w, s, true);
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        s->outSent += (int)n;
+    }
+    s->outLen = s->outSent = 0;
+    return WatchWrites(w, s, false);
+}
+
+static bool ReadSession(Worker *w, Session *s)
+{
+    ssize_t n = recv(s->fd, s->in + s->inLen, sizeof(s->in) - (size_t)s->inLen, 0);
+    if (n == 0)
+        return false;
+    if (n < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    s->inLen += (int)n;
+
+    int count = s->inLen / (int)sizeof(NetRequest);
+    for (int i = 0; i < count; i++)
+    {
+        NetRequest req;
+        memcpy(&req, s->in + i * sizeof(NetRequest), sizeof(req));
+        NetResponse res;
+        ServeRequest(w, s, &req, &res);
+        memcpy(s->out + s->outLen, &res, sizeof(res));
+        s->outLen += (int)sizeof(res);
+    }
+    s->inLen -= count * (int)sizeof(NetRequest);
+    if (s->inLen > 0)
+        memmove(s->in, s->in + count * sizeof(NetRequest), (size_t)s->inLen);
+
+    return FlushSession(w, s);
+}
+
+static void AcceptSessions(Worker *w)
+{
+    for (;;)
+    {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept");
+            return;
+        }
+
+        Session *s = calloc(1, sizeof(Session));
+        if (!s || !NetSetNonBlocking(fd))
+        {
+            free(s);
+            close(fd);
+            continue;
+        }
+        s->fd = fd;
+        if (listenTcp)
+        {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = s;
+        if (epoll_ctl(w->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            free(s);
+            close(fd);
+            continue;
+        }
+        __atomic_fetch_add(&w->sessions, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void *WorkerMain(void *arg)
+{
+    Worker *w = (Worker *)arg;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running)
+    {
+        int n = epoll_wait(w->epollFd, events, MAX_EVENTS, 200);
+        for (int i = 0; i < n; i++)
+        {
+            Session *s = (Session *)events[i].data.ptr;
+            if (!s)
+            {
+                AcceptSessions(w);
+                continue;
+            }
+
+            bool ok;
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+                ok = false;
+            else if (s->writing)
+                ok = FlushSession(w, s);
+            else
+                ok = ReadSession(w, s);
+            if (!ok)
+                CloseSession(w, s);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *socketPath = NET_DEFAULT_SOCKET;
+    int port = 0;
+    uint64_t seed = (uint64_t)time(NULL);
+    workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            workerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else
+        {
+            fprintf(stderr, "uso: %s [--socket caminho | --tcp porta] [--threads N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > MAX_WORKERS)
+        workerCount = MAX_WORKERS;
+
+    NetRaiseFileLimit();
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    listenFd = Listen(socketPath, port);
+    listenTcp = port > 0;
+    if (listenFd < 0)
+    {
+        perror("listen");
+        return 1;
+    }
+
+    /* Every worker waits on the listening socket too; EPOLLEXCLUSIVE wakes
+       only one of them per incoming connection. */
+    Rng seeder;
+    RngSeed(&seeder, seed);
+    for (int i = 0; i < workerCount; i++)
+    {
+        Worker *w = &workers[i];
+        w->id = i;
+        w->rng = seeder;
+        RngJump(&seeder);
+        w->epollFd = epoll_create1(0);
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.ptr = NULL;
+        if (w->epollFd < 0 || epoll_ctl(w->epollFd, EPOLL_CTL_ADD, listenFd, &ev) != 0)
+        {
+            perror("epoll");
+            return 1;
+        }
+    }
+
+    pthread_t threads[MAX_WORKERS];
+    for (int i = 0; i < workerCount; i++)
+        pthread_create(&threads[i], NULL, WorkerMain, &workers[i]);
+
+    if (port > 0)
+        printf("Servidor em 127.0.0.1:%d com %d threads\n", port, workerCount);
+    else
+        printf("Servidor em %s com %d threads\n", socketPath, workerCount);
+    fflush(stdout);
+
+    long long lastTurns = 0;
+    double lastTime = Now();
+    while (running)
+    {
+        usleep(100000);
+        double now = Now();
+        if (now - lastTime < STATS_INTERVAL)
+            continue;
+
+        long long turns = 0, battles = 0, sessions = 0;
+        for (int i = 0; i < workerCount; i++)
+        {
+            turns += __atomic_load_n(&workers[i].turns, __ATOMIC_RELAXED);
+            battles += __atomic_load_n(&workers[i].battles, __ATOMIC_RELAXED);
+            sessions += __atomic_load_n(&workers[i].sessions, __ATOMIC_RELAXED);
+        }
+        printf("%lld sessoes, %lld batalhas, %.0f turnos/s\n", sessions, battles, (turns - lastTurns) / (now - lastTime));
+        fflush(stdout);
+        lastTurns = turns;
+        lastTime = now;
+    }
+
+    for (int i = 0; i < workerCount; i++)
+        pthread_join(threads[i], NULL);
+    close(listenFd);
+    if (port == 0)
+        unlink(socketPath);
+    return 0;
+}
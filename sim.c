@@ -0,0 +1,219 @@
+#include "combat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_BUILDS (1 << STAGE_COUNT)
+#define MAX_WORKERS 64
+#define BATTLES_PER_TASK 16384
+#define MAX_TURNS 1000
+
+typedef struct
+{
+    long long wins;
+    long long losses;
+    long long escapes;
+    long long turns;
+} BuildStats;
+
+typedef struct
+{
+    int build;
+    int count;
+    uint64_t seed;
+} Task;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    Task *tasks;
+    int top;
+    int bottom;
+} TaskDeque;
+
+typedef struct
+{
+    int id;
+    BuildStats stats[MAX_BUILDS];
+} Worker;
+
+static ItemType builds[MAX_BUILDS][INVENTORY_SIZE];
+static int buildCount;
+
+static TaskDeque deques[MAX_WORKERS];
+static Worker workers[MAX_WORKERS];
+static int workerCount;
+
+static void RunBattles(const Task *task, BuildStats *stats)
+{
+    Rng rng;
+    RngSeed(&rng, task->seed);
+
+    for (int n = 0; n < task->count; n++)
+    {
+        Battle b;
+        BattleInit(&b, builds[task->build]);
+
+        while (b.outcome == BATTLE_ONGOING && b.turns < MAX_TURNS)
+        {
+            if (!BattlePlayerAct(&b, CombatHeuristicAction(&b), &rng))
+                BattlePlayerAct(&b, ACTION_ATTACK, &rng);
+            if (b.outcome != BATTLE_ONGOING)
+                break;
+            BattleBossAct(&b, &rng);
+        }
+
+        if (b.outcome == BATTLE_WON)
+            stats->wins++;
+        else if (b.outcome == BATTLE_ESCAPED)
+            stats->escapes++;
+        else
+            stats->losses++;
+        stats->turns += b.turns;
+    }
+}
+
+static bool PopTask(int self, Task *out)
+{
+    TaskDeque *d = &deques[self];
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top)
+    {
+        *out = d->tasks[--d->bottom];
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static bool StealTask(int self, Task *out)
+{
+    for (int i = 1; i < workerCount; i++)
+    {
+        TaskDeque *d = &deques[(self + i) % workerCount];
+        bool found = false;
+        pthread_mutex_lock(&d->lock);
+        if (d->bottom > d->top)
+        {
+            *out = d->tasks[d->top++];
+            found = true;
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+static void *WorkerMain(void *arg)
+{
+    Worker *w = (Worker *)arg;
+    Task task;
+    while (PopTask(w->id, &task) || StealTask(w->id, &task))
+        RunBattles(&task, &w->stats[task.build]);
+    return NULL;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    long long battlesPerBuild = (argc > 1) ? atoll(argv[1]) : 1000000;
+    workerCount = (argc > 2) ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+
+    if (battlesPerBuild < 1)
+        battlesPerBuild = 1;
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > MAX_WORKERS)
+        workerCount = MAX_WORKERS;
+
+    buildCount = CombatEnumerateBuilds(builds, MAX_BUILDS);
+
+    long long tasksPerBuild = (battlesPerBuild + BATTLES_PER_TASK - 1) / BATTLES_PER_TASK;
+    long long taskCount = tasksPerBuild * buildCount;
+    long long perWorker = (taskCount + workerCount - 1) / workerCount;
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        pthread_mutex_init(&deques[i].lock, NULL);
+        deques[i].tasks = malloc(sizeof(Task) * (size_t)perWorker);
+        deques[i].top = 0;
+        deques[i].bottom = 0;
+        workers[i].id = i;
+        memset(workers[i].stats, 0, sizeof(workers[i].stats));
+    }
+
+    long long t = 0;
+    for (int b = 0; b < buildCount; b++)
+    {
+        long long remaining = battlesPerBuild;
+        for (long long k = 0; k < tasksPerBuild; k++, t++)
+        {
+            Task task;
+            task.build = b;
+            task.count = (int)(remaining < BATTLES_PER_TASK ? remaining : BATTLES_PER_TASK);
+            uint64_t mix = seed ^ ((uint64_t)t * 0xD1B54A32D192ED03ull);
+            task.seed = RngSplitMix(&mix);
+            remaining -= task.count;
+
+            TaskDeque *d = &deques[t % workerCount];
+            d->tasks[d->bottom++] = task;
+        }
+    }
+
+    double start = Now();
+    pthread_t threads[MAX_WORKERS];
+    for (int i = 1; i < workerCount; i++)
+        pthread_create(&threads[i], NULL, WorkerMain, &workers[i]);
+    WorkerMain(&workers[0]);
+    for (int i = 1; i < workerCount; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed = Now() - start;
+
+    printf("%-36s %10s %10s %10s %8s\n", "Build", "Vitoria", "Derrota", "Fuga", "Turnos");
+    for (int b = 0; b < buildCount; b++)
+    {
+        BuildStats total = {0};
+        for (int i = 0; i < workerCount; i++)
+        {
+            total.wins += workers[i].stats[b].wins;
+            total.losses += workers[i].stats[b].losses;
+            total.escapes += workers[i].stats[b].escapes;
+            total.turns += workers[i].stats[b].turns;
+        }
+
+        char name[64] = "";
+        for (int s = 0; s < INVENTORY_SIZE; s++)
+        {
+            if (s > 0)
+                strcat(name, "+");
+            strcat(name, GetItemShortName(builds[b][s]));
+        }
+
+        double n = (double)battlesPerBuild;
+        printf("%-36s %9.3f%% %9.3f%% %9.3f%% %8.2f\n", name,
+               100.0 * total.wins / n, 100.0 * total.losses / n, 100.0 * total.escapes / n, total.turns / n);
+    }
+
+    double battles = (double)battlesPerBuild * buildCount;
+    printf("\n%.0f batalhas em %.3f s com %d threads (%.2f M batalhas/s)\n",
+           battles, elapsed, workerCount, battles / elapsed / 1e6);
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        pthread_mutex_destroy(&deques[i].lock);
+        free(deques[i].tasks);
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "combat.h"
+#include "policy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define ALL_MASKS (1 << INVENTORY_SIZE)
+
+typedef struct
+{
+    ItemType inventory[INVENTORY_SIZE];
+    float escapeValue;
+    float *turnValue;
+    float *bossValue;
+    uint16_t *values;
+    int8_t *actions;
+} SolveJob;
+
+static float AfterPlayer(const SolveJob *job, int playerHp, int bossHp, unsigned mask, bool armor)
+{
+    if (bossHp <= 0)
+        return 1.0f;
+    return job->bossValue[PolicyIndex(playerHp, bossHp, mask, armor)];
+}
+
+static float AverageHit(const SolveJob *job, int playerHp, int bossHp, unsigned mask, bool armor, int min, int max)
+{
+    float sum = 0.0f;
+    for (int d = min; d <= max; d++)
+        sum += AfterPlayer(job, playerHp, bossHp - d, mask, armor);
+    return sum / (float)(max - min + 1);
+}
+
+/* Boss-turn and player-turn values are filled bottom-up: masks that have more
+   items spent and the armored half come first, then boss hp and player hp
+   ascending. Every transition points to a state already computed. */
+static void *SolveBuild(void *arg)
+{
+    SolveJob *job = (SolveJob *)arg;
+
+    bool hasSword = false;
+    for (int i = 0; i < INVENTORY_SIZE; i++)
+        hasSword = hasSword || job->inventory[i] == ITEM_SWORD;
+
+    int atkMin, atkMax;
+    CombatPlayerDamageRange(hasSword, &atkMin, &atkMax);
+
+    for (int mask = ALL_MASKS - 1; mask >= 0; mask--)
+    {
+        for (int armor = 1; armor >= 0; armor--)
+        {
+            int bossMin, bossMax;
+            CombatBossDamageRange(BOSS_START_ATTACK, armor, &bossMin, &bossMax);
+
+            for (int b = 0; b < POLICY_BOSS_HP; b++)
+            {
+                for (int p = 0; p < POLICY_PLAYER_HP; p++)
+                {
+                    int idx = PolicyIndex(p, b, (unsigned)mask, armor);
+                    if (b == 0 || p == 0)
+                    {
+                        job->turnValue[idx] = (b == 0) ? 1.0f : 0.0f;
+                        job->bossValue[idx] = job->turnValue[idx];
+                        job->actions[idx] = ACTION_ATTACK;
+                        continue;
+                    }
+
+                    float bossSum = 0.0f;
+                    for (int e = bossMin; e <= bossMax; e++)
+                        bossSum += (p - e > 0) ? job->turnValue[PolicyIndex(p - e, b, (unsigned)mask, armor)] : 0.0f;
+                    float wasted = bossSum / (float)(bossMax - bossMin + 1);
+                    job->bossValue[idx] = wasted;
+
+                    float best = AverageHit(job, p, b, (unsigned)mask, armor, atkMin, atkMax);
+                    int bestAction = ACTION_ATTACK;
+
+                    for (int s = 0; s < INVENTORY_SIZE; s++)
+                    {
+                        unsigned bit = 1u << s;
+                        if (mask & bit)
+                            continue;
+
+                        unsigned spent = (unsigned)mask | bit;
+                        float v;
+                        switch (job->inventory[s])
+                        {
+                        case ITEM_POTION:
+                        {
+                            int healed = p + POTION_HEAL;
+                            if (healed > PLAYER_START_HP)
+                                healed = PLAYER_START_HP;
+                            v = job->bossValue[PolicyIndex(healed, b, spent, armor)];
+                            break;
+                        }
+                        case ITEM_SWORD:
+                            continue;
+                        case ITEM_BOMB:
+                            v = AverageHit(job, p, b, spent, armor, BOMB_MIN_DAMAGE, BOMB_MAX_DAMAGE);
+                            break;
+                        case ITEM_COIN:
+                            v = 0.5f * job->escapeValue + 0.5f * job->bossValue[PolicyIndex(p, b, spent, armor)];
+                            break;
+                        case ITEM_ARMOR:
+                            v = job->bossValue[PolicyIndex(p, b, (unsigned)mask, true)];
+                            break;
+                        default:
+                            v = wasted;
+                            break;
+                        }
+
+                        if (v > best + 1e-6f)
+                        {
+                            best = v;
+                            bestAction = s;
+                        }
+                    }
+
+                    job->turnValue[idx] = best;
+                    job->actions[idx] = (int8_t)bestAction;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < POLICY_STATES; i++)
+        job->values[i] = (uint16_t)(job->turnValue[i] * POLICY_VALUE_SCALE + 0.5f);
+    return NULL;
+}
+
+static bool WriteTable(const char *path, const SolveJob *jobs, int buildCount)
+{
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *f = fopen(tmpPath, "wb");
+    if (!f)
+        return false;
+
+    PolicyHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, POLICY_MAGIC, 4);
+    h.version = POLICY_VERSION;
+    h.buildCount = (uint32_t)buildCount;
+    h.playerHp = POLICY_PLAYER_HP;
+    h.bossHp = POLICY_BOSS_HP;
+    h.stateCount = POLICY_STATES;
+    fwrite(&h, sizeof(h), 1, f);
+
+    for (int b = 0; b < buildCount; b++)
+    {
+        PolicyBuild pb;
+        memset(&pb, 0, sizeof(pb));
+        for (int i = 0; i < INVENTORY_SIZE; i++)
+            pb.inventory[i] = (uint8_t)jobs[b].inventory[i];
+        fwrite(&pb, sizeof(pb), 1, f);
+    }
+    for (int b = 0; b < buildCount; b++)
+        fwrite(jobs[b].values, sizeof(uint16_t), POLICY_STATES, f);
+    for (int b = 0; b < buildCount; b++)
+        fwrite(jobs[b].actions, sizeof(int8_t), POLICY_STATES, f);
+
+    bool ok = ferror(f) == 0;
+    ok = (fclose(f) == 0) && ok;
+    return ok && rename(tmpPath, path) == 0;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "policy.rrpt";
+    float escapeValue = (argc > 2) ? (float)atof(argv[2]) : 0.0f;
+
+    ItemType builds[POLICY_MAX_BUILDS][INVENTORY_SIZE];
+    int buildCount = CombatEnumerateBuilds(builds, POLICY_MAX_BUILDS);
+
+    SolveJob jobs[POLICY_MAX_BUILDS];
+    pthread_t threads[POLICY_MAX_BUILDS];
+
+    double start = Now();
+    for (int b = 0; b < buildCount; b++)
+    {
+        memcpy(jobs[b].inventory, builds[b], sizeof(builds[b]));
+        jobs[b].escapeValue = escapeValue;
+        jobs[b].turnValue = malloc(sizeof(float) * POLICY_STATES);
+        jobs[b].bossValue = malloc(sizeof(float) * POLICY_STATES);
+        jobs[b].values = malloc(sizeof(uint16_t) * POLICY_STATES);
+        jobs[b].actions = malloc(sizeof(int8_t) * POLICY_STATES);
+        pthread_create(&threads[b], NULL, SolveBuild, &jobs[b]);
+    }
+    for (int b = 0; b < buildCount; b++)
+        pthread_join(threads[b], NULL);
+    double elapsed = Now() - start;
+
+    printf("%-36s %10s  %s\n", "Build", "Vitoria", "Primeira acao");
+    for (int b = 0; b < buildCount; b++)
+    {
+        char name[64] = "";
+        for (int s = 0; s < INVENTORY_SIZE; s++)
+        {
+            if (s > 0)
+                strcat(name, "+");
+            strcat(name, GetItemShortName(jobs[b].inventory[s]));
+        }
+
+        int idx = PolicyIndex(PLAYER_START_HP, BOSS_START_HP, 0, false);
+        int action = jobs[b].actions[idx];
+        printf("%-36s %9.4f%%  %s\n", name, 100.0f * jobs[b].turnValue[idx],
+               action == ACTION_ATTACK ? "Atacar" : GetItemShortName(jobs[b].inventory[action]));
+    }
+    printf("\n%d builds x %d estados resolvidos em %.3f s\n", buildCount, POLICY_STATES, elapsed);
+
+    bool ok = WriteTable(path, jobs, buildCount);
+    if (ok)
+        printf("Tabela salva em %s\n", path);
+    else
+        fprintf(stderr, "Erro ao salvar %s\n", path);
+
+    for (int b = 0; b < buildCount; b++)
+    {
+        free(jobs[b].turnValue);
+        free(jobs[b].bossValue);
+        free(jobs[b].values);
+        free(jobs[b].actions);
+    }
+    return ok ? 0 : 1;
+}
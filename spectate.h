@@ -0,0 +1,310 @@
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+#include "combat.h"
+#include "battlelog.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SPECTATE_MAGIC "RRSP"
+#define SPECTATE_VERSION 2
+#define SPECTATE_DEFAULT_NAME "/rush_rpg_spectate"
+#define SPECTATE_SLOTS 1024
+#define SPECTATE_SLOT_DATA 256
+#define SPECTATE_LOG_SIZE 16
+#define SPECTATE_KEYFRAME_TICKS 120
+#define SPECTATE_KEYFRAME 1u
+#define SPECTATE_SLOT_BUSY UINT64_MAX
+
+typedef struct
+{
+    int32_t hp;
+    int32_t maxHp;
+    int32_t attackFrame;
+    float attackTimer;
+    float hurtTimer;
+} SpectateCombatant;
+
+/* Everything DrawBattle and the ending screens read, in 4-byte words so a
+   delta can name the words that changed. The newest log entries sit in
+   ring order, so a new line changes two words rather than the whole tail. */
+typedef struct
+{
+    uint32_t gameState;
+    uint32_t battleState;
+    int32_t selectedItemIndex;
+    uint8_t inventory[INVENTORY_SIZE];
+    uint8_t itemUsed[INVENTORY_SIZE];
+    uint8_t playerHasArmor;
+    uint8_t reserved[3];
+    SpectateCombatant player;
+    SpectateCombatant boss;
+    uint32_t logTotal;
+    BattleLogEntry log[SPECTATE_LOG_SIZE];
+} SpectateState;
+
+#define SPECTATE_WORDS ((int)(sizeof(SpectateState) / sizeof(uint32_t)))
+#define SPECTATE_MASK_WORDS ((SPECTATE_WORDS + 31) / 32)
+
+/* A slot is valid while seq holds its sequence number; the writer sets
+   SPECTATE_SLOT_BUSY while filling it, so a reader that sees the same seq
+   before and after copying knows the copy is whole. */
+typedef struct
+{
+    uint64_t seq;
+    uint32_t size;
+    uint32_t flags;
+    uint8_t data[SPECTATE_SLOT_DATA];
+} SpectateSlot;
+
+/* Shared-memory ring with one writer and any number of readers. Readers
+   never write to it, so each added spectator costs the game nothing. A
+   keyframe carries the whole state; a delta carries a bitmask of changed
+   words followed by those words, relative to the record just before it.
+   A reader that joins late or falls more than SPECTATE_SLOTS behind waits
+   for the next keyframe. */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t stateSize;
+    uint64_t writeSeq;
+    SpectateSlot slots[SPECTATE_SLOTS];
+} SpectateRing;
+
+typedef struct
+{
+    SpectateRing *ring;
+    char name[64];
+    SpectateState last;
+    int ticksSinceKeyframe;
+    bool hasLast;
+    uint64_t records;
+    uint64_t keyframes;
+    uint64_t bytes;
+} SpectatePublisher;
+
+typedef struct
+{
+    const SpectateRing *ring;
+    uint64_t nextSeq;
+    bool synced;
+} SpectateReader;
+
+static inline bool SpectatePublisherOpen(SpectatePublisher *p, const char *name)
+{
+    memset(p, 0, sizeof(*p));
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+    if (ftruncate(fd, sizeof(SpectateRing)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, sizeof(SpectateRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    p->ring = (SpectateRing *)data;
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    memset(p->ring, 0, sizeof(SpectateRing));
+    memcpy(p->ring->magic, SPECTATE_MAGIC, 4);
+    p->ring->version = SPECTATE_VERSION;
+    p->ring->slotCount = SPECTATE_SLOTS;
+    p->ring->stateSize = (uint32_t)sizeof(SpectateState);
+    __atomic_store_n(&p->ring->writeSeq, 1, __ATOMIC_RELEASE);
+    return true;
+#endif
+}
+
+static inline void SpectatePublisherClose(SpectatePublisher *p)
+{
+    if (!p->ring)
+        return;
+#ifndef _WIN32
+    munmap(p->ring, sizeof(SpectateRing));
+    shm_unlink(p->name);
+#endif
+    p->ring = NULL;
+}
+
+/* Publishes one tick. Unchanged ticks write nothing, except that a keyframe
+   goes out at least every SPECTATE_KEYFRAME_TICKS so late joiners can sync. */
+static inline void SpectatePublish(SpectatePublisher *p, const SpectateState *state)
+{
+    uint8_t payload[SPECTATE_SLOT_DATA];
+    uint32_t size = 0, flags = 0;
+
+    if (!p->hasLast || ++p->ticksSinceKeyframe >= SPECTATE_KEYFRAME_TICKS)
+    {
+        memcpy(payload, state, sizeof(*state));
+        size = (uint32_t)sizeof(*state);
+        flags = SPECTATE_KEYFRAME;
+        p->ticksSinceKeyframe = 0;
+        p->keyframes++;
+    }
+    else
+    {
+        const uint32_t *now = (const uint32_t *)state;
+        const uint32_t *before = (const uint32_t *)&p->last;
+        uint32_t mask[SPECTATE_MASK_WORDS] = {0};
+        size = sizeof(mask);
+        for (int w = 0; w < SPECTATE_WORDS; w++)
+        {
+            if (now[w] == before[w])
+                continue;
+            mask[w / 32] |= 1u << (w % 32);
+            memcpy(payload + size, &now[w], sizeof(uint32_t));
+            size += sizeof(uint32_t);
+        }
+        if (size == sizeof(mask))
+            return;
+        memcpy(payload, mask, sizeof(mask));
+    }
+
+    SpectateRing *ring = p->ring;
+    uint64_t seq = __atomic_load_n(&ring->writeSeq, __ATOMIC_RELAXED);
+    SpectateSlot *slot = &ring->slots[seq % SPECTATE_SLOTS];
+    __atomic_store_n(&slot->seq, SPECTATE_SLOT_BUSY, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->size = size;
+    slot->flags = flags;
+    memcpy(slot->data, payload, size);
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->writeSeq, seq + 1, __ATOMIC_RELEASE);
+
+    p->last = *state;
+    p->hasLast = true;
+    p->records++;
+    p->bytes += size;
+}
+
+static inline bool SpectateReaderOpen(SpectateReader *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SpectateRing))
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, sizeof(SpectateRing), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const SpectateRing *ring = (const SpectateRing *)data;
+    if (memcmp(ring->magic, SPECTATE_MAGIC, 4) != 0 || ring->version != SPECTATE_VERSION ||
+        ring->slotCount != SPECTATE_SLOTS || ring->stateSize != sizeof(SpectateState))
+    {
+        munmap(data, sizeof(SpectateRing));
+        return false;
+    }
+    r->ring = ring;
+    r->nextSeq = __atomic_load_n(&ring->writeSeq, __ATOMIC_ACQUIRE);
+    return true;
+#endif
+}
+
+static inline void SpectateReaderClose(SpectateReader *r)
+{
+#ifndef _WIN32
+    if (r->ring)
+        munmap((void *)r->ring, sizeof(SpectateRing));
+#endif
+    r->ring = NULL;
+}
+
+static inline void SpectateApplyDelta(SpectateState *state, const uint8_t *payload, uint32_t size)
+{
+    uint32_t mask[SPECTATE_MASK_WORDS];
+    memcpy(mask, payload, sizeof(mask));
+    uint32_t *words = (uint32_t *)state;
+    uint32_t offset = sizeof(mask);
+    for (int w = 0; w < SPECTATE_WORDS && offset + sizeof(uint32_t) <= size; w++)
+    {
+        if (mask[w / 32] & (1u << (w % 32)))
+        {
+            memcpy(&words[w], payload + offset, sizeof(uint32_t));
+            offset += sizeof(uint32_t);
+        }
+    }
+}
+
+/* Applies every record published since the last call to *state and returns
+   how many were applied. */
+static inline int SpectatePoll(SpectateReader *r, SpectateState *state)
+{
+    const SpectateRing *ring = r->ring;
+    uint64_t end = __atomic_load_n(&ring->writeSeq, __ATOMIC_ACQUIRE);
+    if (end < r->nextSeq || end - r->nextSeq > SPECTATE_SLOTS)
+    {
+        r->nextSeq = end > SPECTATE_SLOTS ? end - SPECTATE_SLOTS : 1;
+        r->synced = false;
+    }
+
+    int applied = 0;
+    for (; r->nextSeq < end; r->nextSeq++)
+    {
+        const SpectateSlot *slot = &ring->slots[r->nextSeq % SPECTATE_SLOTS];
+        uint8_t payload[SPECTATE_SLOT_DATA];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != r->nextSeq)
+        {
+            r->synced = false;
+            continue;
+        }
+        uint32_t size = slot->size, flags = slot->flags;
+        if (size > SPECTATE_SLOT_DATA)
+            size = SPECTATE_SLOT_DATA;
+        memcpy(payload, slot->data, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != r->nextSeq)
+        {
+            r->synced = false;
+            continue;
+        }
+
+        if (flags & SPECTATE_KEYFRAME)
+        {
+            if (size != sizeof(SpectateState))
+                continue;
+            memcpy(state, payload, sizeof(SpectateState));
+            r->synced = true;
+        }
+        else if (r->synced && size >= SPECTATE_MASK_WORDS * sizeof(uint32_t))
+        {
+            SpectateApplyDelta(state, payload, size);
+        }
+        else
+        {
+            continue;
+        }
+        applied++;
+    }
+    return applied;
+}
+
+#endif
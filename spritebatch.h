@@ -0,0 +1,101 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "atlas.h"
+#include "profiler.h"
+#include <stdint.h>
+#include <string.h>
+
+#define SPRITE_BATCH_MAX 65536
+#define SPRITE_LAYER_COUNT 8
+#define SPRITE_BUCKETS (SPRITE_LAYER_COUNT * ATLAS_MAX_PAGES)
+
+/* Atlas sprites queued during a frame and drawn together at flush time,
+   ordered by layer and then atlas page so each page is bound once per layer.
+   Quads go straight into rlgl's vertex batch instead of one DrawTexturePro
+   per sprite. Rotation is not supported; none of the game's sprites rotate. */
+typedef struct
+{
+    Rectangle src;
+    Rectangle dest;
+    Vector2 origin;
+    Color tint;
+    uint16_t bucket;
+} SpriteInstance;
+
+static SpriteInstance spriteInstances[SPRITE_BATCH_MAX];
+static SpriteInstance spriteSorted[SPRITE_BATCH_MAX];
+static int spriteInstanceCount = 0;
+
+/* Same arguments as AtlasDraw plus a layer; higher layers draw on top. */
+static inline void SpriteBatchPush(SpriteId id, Rectangle src, Rectangle dest, Vector2 origin, Color tint, int layer)
+{
+    if (spriteInstanceCount >= SPRITE_BATCH_MAX || !AtlasHas(id))
+        return;
+    const AtlasSprite *s = &atlasSprites[id];
+    SpriteInstance *inst = &spriteInstances[spriteInstanceCount++];
+    inst->src = (Rectangle){src.x + s->rect.x, src.y + s->rect.y, src.width, src.height};
+    inst->dest = dest;
+    inst->origin = origin;
+    inst->tint = tint;
+    inst->bucket = (uint16_t)(layer * ATLAS_MAX_PAGES + s->page);
+}
+
+static inline void SpriteBatchEmit(const SpriteInstance *inst, float texWidth, float texHeight)
+{
+    float u0 = inst->src.x / texWidth, v0 = inst->src.y / texHeight;
+    float u1 = (inst->src.x + inst->src.width) / texWidth, v1 = (inst->src.y + inst->src.height) / texHeight;
+    float x0 = inst->dest.x - inst->origin.x, y0 = inst->dest.y - inst->origin.y;
+    float x1 = x0 + inst->dest.width, y1 = y0 + inst->dest.height;
+
+    rlCheckRenderBatchLimit(4);
+    rlColor4ub(inst->tint.r, inst->tint.g, inst->tint.b, inst->tint.a);
+    rlTexCoord2f(u0, v0);
+    rlVertex2f(x0, y0);
+    rlTexCoord2f(u0, v1);
+    rlVertex2f(x0, y1);
+    rlTexCoord2f(u1, v1);
+    rlVertex2f(x1, y1);
+    rlTexCoord2f(u1, v0);
+    rlVertex2f(x1, y0);
+}
+
+/* Counting sort on (layer, page) keeps push order inside a bucket, then one
+   texture bind and one quad run per bucket. */
+static inline void SpriteBatchFlush(void)
+{
+    int n = spriteInstanceCount;
+    spriteInstanceCount = 0;
+    if (n == 0)
+        return;
+
+    int start[SPRITE_BUCKETS + 1] = {0};
+    for (int i = 0; i < n; i++)
+        start[spriteInstances[i].bucket + 1]++;
+    for (int b = 0; b < SPRITE_BUCKETS; b++)
+        start[b + 1] += start[b];
+    int fill[SPRITE_BUCKETS];
+    memcpy(fill, start, sizeof(fill));
+    for (int i = 0; i < n; i++)
+        spriteSorted[fill[spriteInstances[i].bucket]++] = spriteInstances[i];
+
+    for (int b = 0; b < SPRITE_BUCKETS; b++)
+    {
+        if (start[b] == start[b + 1])
+            continue;
+        Texture2D page = atlasPages[b % ATLAS_MAX_PAGES];
+        rlSetTexture(page.id);
+        rlBegin(RL_QUADS);
+        for (int i = start[b]; i < start[b + 1]; i++)
+        {
+            PROF_COUNT_DRAW(page.id);
+            SpriteBatchEmit(&spriteSorted[i], (float)page.width, (float)page.height);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef STAGEGEN_H
+#define STAGEGEN_H
+
+#include "raylib.h"
+#include "combat.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STAGEGEN_AHEAD 4
+#define STAGEGEN_WORKERS 2
+#define STAGEGEN_BG_WIDTH 500
+#define STAGEGEN_BG_HEIGHT 350
+#define STAGEGEN_STORY_SIZE 192
+#define STAGEGEN_LABEL_SIZE 32
+
+/* What the player reads and picks in one stage. A pure function of the run's
+   seed and the stage index, cheap enough to build on the main thread. */
+typedef struct
+{
+    int index;
+    char story[STAGEGEN_STORY_SIZE];
+    char doorLabel[2][STAGEGEN_LABEL_SIZE];
+    ItemType item[2];
+} StageContent;
+
+typedef struct
+{
+    StageContent content;
+    Image background;
+} GeneratedStage;
+
+typedef struct
+{
+    Color skyTop;
+    Color skyBottom;
+    Color far;
+    Color near;
+    Color floor;
+    Color light;
+} StageTheme;
+
+static const char *const stageGenPlaces[] = {
+    "Voce desce por uma cripta umida e silenciosa.",
+    "Uma ponte de corda balanca sobre o abismo.",
+    "O salao de banquetes esta coberto de poeira.",
+    "Tochas iluminam uma biblioteca em ruinas.",
+    "Raizes atravessam as paredes de uma estufa antiga.",
+    "O vento uiva pelas ameias da torre norte.",
+    "Correntes pendem do teto da masmorra.",
+    "Um lago subterraneo reflete cristais azuis.",
+};
+
+static const char *const stageGenPrompts[] = {
+    "Dois objetos chamam sua atencao. Qual voce leva?",
+    "So da tempo de levar um deles.",
+    "Algo se mexe nas sombras. Escolha rapido.",
+    "Um velho mercador oferece uma troca.",
+    "Dois baus estao abertos a sua frente.",
+    "Os passos do chefe ecoam ao longe.",
+};
+
+static const char *const stageGenLabels[][4] = {
+    [ITEM_POTION] = {"Beber da Fonte", "Comer Frutas", "Usar Curativos", "Tonico Vital"},
+    [ITEM_SWORD] = {"Espada Antiga", "Lamina Curva", "Sabre Velho", "Machado Leve"},
+    [ITEM_BOMB] = {"Bomba Caseira", "Polvora Negra", "Frasco Volatil", "Pavio Aceso"},
+    [ITEM_COIN] = {"Bolsa de Ouro", "Moeda de Prata", "Bau de Joias", "Anel Dourado"},
+    [ITEM_ARMOR] = {"Armadura Leve", "Cota de Malha", "Escudo Velho", "Elmo Amassado"},
+};
+
+/* Chance of each item behind a door, indexed by ItemType. */
+static const int stageGenItemWeights[] = {0, 4, 2, 2, 1, 2};
+
+static const StageTheme stageGenThemes[] = {
+    {{12, 14, 40, 255}, {60, 70, 120, 255}, {34, 38, 70, 255}, {20, 22, 38, 255}, {40, 36, 48, 255}, {255, 200, 110, 255}},
+    {{40, 16, 50, 255}, {190, 90, 90, 255}, {90, 40, 70, 255}, {40, 18, 36, 255}, {60, 40, 44, 255}, {255, 180, 90, 255}},
+    {{14, 32, 24, 255}, {90, 130, 90, 255}, {40, 70, 50, 255}, {20, 36, 26, 255}, {44, 52, 36, 255}, {220, 255, 160, 255}},
+    {{30, 8, 6, 255}, {170, 60, 20, 255}, {80, 24, 14, 255}, {36, 10, 8, 255}, {56, 30, 22, 255}, {255, 150, 60, 255}},
+    {{70, 110, 160, 255}, {220, 200, 160, 255}, {150, 130, 110, 255}, {90, 76, 64, 255}, {120, 100, 80, 255}, {255, 240, 200, 255}},
+    {{20, 40, 70, 255}, {170, 210, 230, 255}, {110, 140, 170, 255}, {50, 70, 100, 255}, {140, 160, 180, 255}, {200, 240, 255, 255}},
+};
+
+#define STAGEGEN_COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static inline uint64_t StageGenSeed(uint64_t seed, int index)
+{
+    return seed ^ ((uint64_t)(index + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+static inline ItemType StageGenPickItem(Rng *rng, ItemType except)
+{
+    int total = 0;
+    for (int i = ITEM_POTION; i <= ITEM_ARMOR; i++)
+        total += (i == (int)except) ? 0 : stageGenItemWeights[i];
+    int roll = RngRange(rng, 0, total - 1);
+    for (int i = ITEM_POTION; i <= ITEM_ARMOR; i++)
+    {
+        if (i == (int)except)
+            continue;
+        roll -= stageGenItemWeights[i];
+        if (roll < 0)
+            return (ItemType)i;
+    }
+    return ITEM_POTION;
+}
+
+/* Text, door labels and the two items of stage index. Stages are grouped in
+   floors of STAGE_COUNT, each ending in a boss fight. */
+static inline void StageGenContent(StageContent *out, uint64_t seed, int index)
+{
+    Rng rng;
+    RngSeed(&rng, StageGenSeed(seed, index));
+
+    out->index = index;
+    out->item[0] = StageGenPickItem(&rng, ITEM_NONE);
+    out->item[1] = StageGenPickItem(&rng, out->item[0]);
+    for (int d = 0; d < 2; d++)
+        snprintf(out->doorLabel[d], STAGEGEN_LABEL_SIZE, "%s", stageGenLabels[out->item[d]][RngRange(&rng, 0, 3)]);
+
+    const char *place = stageGenPlaces[RngRange(&rng, 0, STAGEGEN_COUNT_OF(stageGenPlaces) - 1)];
+    const char *prompt = stageGenPrompts[RngRange(&rng, 0, STAGEGEN_COUNT_OF(stageGenPrompts) - 1)];
+    snprintf(out->story, STAGEGEN_STORY_SIZE, "Andar %d, sala %d.\n%s\n%s", index / STAGE_COUNT + 1, index % STAGE_COUNT + 1, place,
+             prompt);
+}
+
+static inline Color StageGenJitter(Rng *rng, Color c)
+{
+    int d = RngRange(rng, -12, 12);
+    int v[3] = {c.r + d, c.g + d, c.b + d};
+    for (int i = 0; i < 3; i++)
+        v[i] = v[i] < 0 ? 0 : (v[i] > 255 ? 255 : v[i]);
+    return (Color){(unsigned char)v[0], (unsigned char)v[1], (unsigned char)v[2], 255};
+}
+
+static inline Color StageGenMix(Color a, Color b, int t, int range)
+{
+    return (Color){(unsigned char)(a.r + (b.r - a.r) * t / range), (unsigned char)(a.g + (b.g - a.g) * t / range),
+                   (unsigned char)(a.b + (b.b - a.b) * t / range), 255};
+}
+
+static inline void StageGenFillRect(Color *px, int x0, int y0, int x1, int y1, Color c)
+{
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > STAGEGEN_BG_WIDTH ? STAGEGEN_BG_WIDTH : x1;
+    y1 = y1 > STAGEGEN_BG_HEIGHT ? STAGEGEN_BG_HEIGHT : y1;
+    for (int y = y0; y < y1; y++)
+    {
+        for (int x = x0; x < x1; x++)
+            px[y * STAGEGEN_BG_WIDTH + x] = c;
+    }
+}
+
+/* Paints a STAGEGEN_BG_WIDTH x STAGEGEN_BG_HEIGHT RGBA backdrop: a sky
+   gradient, a ridge of hills, a crenellated wall with towers and lit
+   windows, and a banded floor. Leaves background empty if out of memory. */
+static inline void StageGenBackground(Image *background, uint64_t seed, int index)
+{
+    const int w = STAGEGEN_BG_WIDTH, h = STAGEGEN_BG_HEIGHT;
+    const int horizon = h * 7 / 10;
+    Color *px = MemAlloc((unsigned int)(w * h * sizeof(Color)));
+    *background = (Image){0};
+    if (!px)
+        return;
+
+    Rng rng;
+    RngSeed(&rng, StageGenSeed(seed, index));
+    RngJump(&rng);
+    StageTheme theme = stageGenThemes[RngRange(&rng, 0, STAGEGEN_COUNT_OF(stageGenThemes) - 1)];
+    theme.skyTop = StageGenJitter(&rng, theme.skyTop);
+    theme.skyBottom = StageGenJitter(&rng, theme.skyBottom);
+    theme.far = StageGenJitter(&rng, theme.far);
+    theme.near = StageGenJitter(&rng, theme.near);
+    theme.floor = StageGenJitter(&rng, theme.floor);
+
+    for (int y = 0; y < horizon; y++)
+    {
+        Color c = StageGenMix(theme.skyTop, theme.skyBottom, y, horizon);
+        for (int x = 0; x < w; x++)
+            px[y * w + x] = c;
+    }
+    int stars = RngRange(&rng, 0, 1) ? RngRange(&rng, 30, 90) : 0;
+    for (int s = 0; s < stars; s++)
+    {
+        int y = RngRange(&rng, 0, horizon / 2);
+        px[y * w + RngRange(&rng, 0, w - 1)] = theme.light;
+    }
+
+    /* Hills: heights at knots every 20..60 pixels, smoothstepped between. */
+    int knotX = 0, knotH = RngRange(&rng, h * 3 / 10, h * 11 / 20);
+    int nextX = RngRange(&rng, 20, 60), nextH = RngRange(&rng, h * 3 / 10, h * 11 / 20);
+    for (int x = 0; x < w; x++)
+    {
+        if (x >= nextX)
+        {
+            knotX = nextX;
+            knotH = nextH;
+            nextX += RngRange(&rng, 20, 60);
+            nextH = RngRange(&rng, h * 3 / 10, h * 11 / 20);
+        }
+        float t = (float)(x - knotX) / (float)(nextX - knotX);
+        t = t * t * (3.0f - 2.0f * t);
+        int top = knotH + (int)((nextH - knotH) * t);
+        for (int y = top; y < horizon; y++)
+            px[y * w + x] = theme.far;
+    }
+
+    int wallTop = RngRange(&rng, h * 9 / 20, h * 11 / 20);
+    int merlon = RngRange(&rng, 8, 16);
+    StageGenFillRect(px, 0, wallTop, w, horizon, theme.near);
+    for (int x = 0; x < w; x += merlon * 2)
+        StageGenFillRect(px, x, wallTop - merlon, x + merlon, wallTop, theme.near);
+
+    int towers = RngRange(&rng, 2, 4);
+    for (int t = 0; t < towers; t++)
+    {
+        int tw = RngRange(&rng, 30, 60);
+        int tx = RngRange(&rng, 0, w - tw);
+        int ty = RngRange(&rng, h / 6, wallTop - 30);
+        StageGenFillRect(px, tx, ty, tx + tw, horizon, theme.near);
+        for (int x = tx; x < tx + tw; x += 10)
+            StageGenFillRect(px, x, ty - 6, x + 5, ty, theme.near);
+        for (int wy = ty + 14; wy < wallTop - 10; wy += 26)
+        {
+            if (RngRange(&rng, 0, 2) > 0)
+                StageGenFillRect(px, tx + tw / 2 - 3, wy, tx + tw / 2 + 3, wy + 10, theme.light);
+        }
+    }
+
+    for (int y = horizon; y < h; y++)
+    {
+        Color c = StageGenMix(theme.near, theme.floor, y - horizon, h - horizon);
+        if ((y - horizon) % 14 == 13)
+            c = StageGenMix(c, theme.near, 1, 2);
+        for (int x = 0; x < w; x++)
+            px[y * w + x] = c;
+    }
+
+    *background = (Image){px, w, h, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+static inline void StageGenerate(GeneratedStage *out, uint64_t seed, int index)
+{
+    StageGenContent(&out->content, seed, index);
+    StageGenBackground(&out->background, seed, index);
+}
+
+/* Worker pool that keeps the STAGEGEN_AHEAD stages starting at the current
+   one generated. Slot i % STAGEGEN_AHEAD holds stage i; moving the window
+   frees the stages behind it and hands their slots to the ones ahead. Only
+   the main thread frees ready slots, so a peeked stage stays valid until the
+   window moves past it. */
+typedef enum
+{
+    STAGEGEN_EMPTY,
+    STAGEGEN_WORKING,
+    STAGEGEN_READY
+} StageGenState;
+
+static GeneratedStage stageGenSlots[STAGEGEN_AHEAD];
+static StageGenState stageGenSlotState[STAGEGEN_AHEAD];
+static int stageGenSlotIndex[STAGEGEN_AHEAD];
+static uint64_t stageGenRunSeed;
+static int stageGenEpoch;
+static int stageGenFirst;
+static pthread_t stageGenThreads[STAGEGEN_WORKERS];
+static pthread_mutex_t stageGenLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stageGenWake = PTHREAD_COND_INITIALIZER;
+static bool stageGenRunning = false;
+
+/* Caller holds stageGenLock. */
+static int StageGenNextJob(void)
+{
+    for (int i = stageGenFirst; i < stageGenFirst + STAGEGEN_AHEAD; i++)
+    {
+        if (stageGenSlotState[i % STAGEGEN_AHEAD] == STAGEGEN_EMPTY)
+            return i;
+    }
+    return -1;
+}
+
+static void *StageGenWorker(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&stageGenLock);
+    while (stageGenRunning)
+    {
+        int index = StageGenNextJob();
+        if (index < 0)
+        {
+            pthread_cond_wait(&stageGenWake, &stageGenLock);
+            continue;
+        }
+
+        int s = index % STAGEGEN_AHEAD;
+        int epoch = stageGenEpoch;
+        uint64_t seed = stageGenRunSeed;
+        stageGenSlotState[s] = STAGEGEN_WORKING;
+        stageGenSlotIndex[s] = index;
+        pthread_mutex_unlock(&stageGenLock);
+
+        GeneratedStage stage;
+        StageGenerate(&stage, seed, index);
+
+        pthread_mutex_lock(&stageGenLock);
+        if (epoch == stageGenEpoch && index >= stageGenFirst)
+        {
+            stageGenSlots[s] = stage;
+            stageGenSlotState[s] = STAGEGEN_READY;
+        }
+        else
+        {
+            UnloadImage(stage.background);
+            stageGenSlotState[s] = STAGEGEN_EMPTY;
+            pthread_cond_broadcast(&stageGenWake);
+        }
+    }
+    pthread_mutex_unlock(&stageGenLock);
+    return NULL;
+}
+
+/* Caller holds stageGenLock. */
+static void StageGenFreeSlot(int s)
+{
+    if (stageGenSlotState[s] != STAGEGEN_READY)
+        return;
+    UnloadImage(stageGenSlots[s].background);
+    stageGenSlots[s].background = (Image){0};
+    stageGenSlotState[s] = STAGEGEN_EMPTY;
+}
+
+/* Starts (or restarts) generating the run with this seed from stage 0.
+   Stages still in flight from a previous run are thrown away. */
+static void StageGenStart(uint64_t seed)
+{
+    pthread_mutex_lock(&stageGenLock);
+    stageGenRunSeed = seed;
+    stageGenEpoch++;
+    stageGenFirst = 0;
+    for (int s = 0; s < STAGEGEN_AHEAD; s++)
+        StageGenFreeSlot(s);
+    if (!stageGenRunning)
+    {
+        stageGenRunning = true;
+        for (int t = 0; t < STAGEGEN_WORKERS; t++)
+            pthread_create(&stageGenThreads[t], NULL, StageGenWorker, NULL);
+    }
+    pthread_cond_broadcast(&stageGenWake);
+    pthread_mutex_unlock(&stageGenLock);
+}
+
+static void StageGenSetWindow(int first)
+{
+    pthread_mutex_lock(&stageGenLock);
+    if (first != stageGenFirst)
+    {
+        stageGenFirst = first;
+        for (int s = 0; s < STAGEGEN_AHEAD; s++)
+        {
+            if (stageGenSlotState[s] == STAGEGEN_READY && stageGenSlotIndex[s] < first)
+                StageGenFreeSlot(s);
+        }
+        pthread_cond_broadcast(&stageGenWake);
+    }
+    pthread_mutex_unlock(&stageGenLock);
+}
+
+/* The generated stage, or NULL while it is still being built. */
+static const GeneratedStage *StageGenPeek(int index)
+{
+    const GeneratedStage *stage = NULL;
+    pthread_mutex_lock(&stageGenLock);
+    int s = index % STAGEGEN_AHEAD;
+    if (index >= 0 && stageGenSlotState[s] == STAGEGEN_READY && stageGenSlotIndex[s] == index)
+        stage = &stageGenSlots[s];
+    pthread_mutex_unlock(&stageGenLock);
+    return stage;
+}
+
+static void StageGenShutdown(void)
+{
+    if (!stageGenRunning)
+        return;
+    pthread_mutex_lock(&stageGenLock);
+    stageGenRunning = false;
+    pthread_cond_broadcast(&stageGenWake);
+    pthread_mutex_unlock(&stageGenLock);
+    for (int t = 0; t < STAGEGEN_WORKERS; t++)
+        pthread_join(stageGenThreads[t], NULL);
+
+    for (int s = 0; s < STAGEGEN_AHEAD; s++)
+        StageGenFreeSlot(s);
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "pack.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define STREAM_MAX_ASSETS 32
+#define STREAM_MIN_ROWS 16
+
+/* Block-compressed textures go up in slices of whole 4-row block rows via
+   glCompressedTexSubImage2D, core since OpenGL 1.3 and exported by the libGL
+   the Linux build links. Elsewhere they are uploaded in one call. */
+#if defined(__linux__) && !defined(STREAM_NO_COMPRESSED_SLICES)
+#define STREAM_COMPRESSED_SLICES 1
+#define STREAM_GL_TEXTURE_2D 0x0DE1
+void glCompressedTexSubImage2D(unsigned int target, int level, int x, int y, int width, int height, unsigned int format,
+                               int size, const void *data);
+#endif
+
+typedef enum
+{
+    STREAM_IDLE,
+    STREAM_QUEUED,
+    STREAM_DECODED,
+    STREAM_UPLOADING,
+    STREAM_READY,
+    STREAM_FAILED
+} StreamState;
+
+/* Assets are decoded (or found in the asset pack) on a worker thread and
+   uploaded on the main thread a few rows at a time (STREAM_MIN_ROWS, a
+   multiple of the 4-row DXT block). Images larger than the
+   asset's max size are downscaled on the worker first. Textures go to
+   *target once fully uploaded; assets registered without a target keep
+   their decoded Image for the caller. */
+typedef struct
+{
+    const char *name;
+    Texture2D *target;
+    StreamState state;
+    Image image;
+    Texture2D texture;
+    int uploadedRows;
+    int maxWidth;
+    int maxHeight;
+} StreamAsset;
+
+static StreamAsset streamAssets[STREAM_MAX_ASSETS];
+static int streamAssetCount = 0;
+static int streamQueue[STREAM_MAX_ASSETS];
+static int streamQueueHead = 0;
+static int streamQueueTail = 0;
+static pthread_t streamThread;
+static pthread_mutex_t streamLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t streamWake = PTHREAD_COND_INITIALIZER;
+static bool streamRunning = false;
+
+Image LoadAssetImage(const char *baseName);
+
+static void *StreamWorker(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&streamLock);
+    while (streamRunning)
+    {
+        if (streamQueueHead == streamQueueTail)
+        {
+            pthread_cond_wait(&streamWake, &streamLock);
+            continue;
+        }
+
+        int h = streamQueue[streamQueueHead % STREAM_MAX_ASSETS];
+        streamQueueHead++;
+        const char *name = streamAssets[h].name;
+        int maxWidth = streamAssets[h].maxWidth;
+        int maxHeight = streamAssets[h].maxHeight;
+        pthread_mutex_unlock(&streamLock);
+
+        Image image = LoadAssetImage(name);
+        if (image.data != NULL && !PackOwns(image.data))
+            ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        if (image.data != NULL && image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 && maxWidth > 0 &&
+            (image.width > maxWidth || image.height > maxHeight))
+        {
+            if (PackOwns(image.data))
+                image = ImageCopy(image);
+            ImageResize(&image, image.width > maxWidth ? maxWidth : image.width,
+                        image.height > maxHeight ? maxHeight : image.height);
+        }
+
+        pthread_mutex_lock(&streamLock);
+        streamAssets[h].image = image;
+        streamAssets[h].state = (image.data != NULL) ? STREAM_DECODED : STREAM_FAILED;
+    }
+    pthread_mutex_unlock(&streamLock);
+    return NULL;
+}
+
+static void StreamInit(void)
+{
+    if (streamRunning)
+        return;
+    streamRunning = true;
+    pthread_create(&streamThread, NULL, StreamWorker, NULL);
+}
+
+/* maxWidth/maxHeight of 0 keep the source resolution. */
+static int StreamRegister(const char *name, Texture2D *target, int maxWidth, int maxHeight)
+{
+    if (streamAssetCount >= STREAM_MAX_ASSETS)
+        return -1;
+    int h = streamAssetCount++;
+    memset(&streamAssets[h], 0, sizeof(streamAssets[h]));
+    streamAssets[h].name = name;
+    streamAssets[h].target = target;
+    streamAssets[h].maxWidth = maxWidth;
+    streamAssets[h].maxHeight = maxHeight;
+    return h;
+}
+
+static void StreamRequest(int h)
+{
+    if (h < 0)
+        return;
+    pthread_mutex_lock(&streamLock);
+    if (streamAssets[h].state == STREAM_IDLE)
+    {
+        streamAssets[h].state = STREAM_QUEUED;
+        streamQueue[streamQueueTail % STREAM_MAX_ASSETS] = h;
+        streamQueueTail++;
+        pthread_cond_signal(&streamWake);
+    }
+    pthread_mutex_unlock(&streamLock);
+}
+
+static StreamState StreamGetState(int h)
+{
+    if (h < 0)
+        return STREAM_FAILED;
+    pthread_mutex_lock(&streamLock);
+    StreamState state = streamAssets[h].state;
+    pthread_mutex_unlock(&streamLock);
+    return state;
+}
+
+static bool StreamIsSettled(int h)
+{
+    StreamState state = StreamGetState(h);
+    return state == STREAM_READY || state == STREAM_FAILED ||
+           (state == STREAM_DECODED && streamAssets[h].target == NULL);
+}
+
+/* True while any asset is still on its way to the GPU or to its caller. */
+static bool StreamIsBusy(void)
+{
+    for (int h = 0; h < streamAssetCount; h++)
+    {
+        StreamState state = StreamGetState(h);
+        if (state == STREAM_QUEUED || state == STREAM_UPLOADING || (state == STREAM_DECODED && streamAssets[h].target != NULL))
+            return true;
+    }
+    return false;
+}
+
+/* Hands a decoded image to the caller, who now owns it. */
+static Image StreamTakeImage(int h)
+{
+    Image image = {0};
+    if (h < 0)
+        return image;
+    pthread_mutex_lock(&streamLock);
+    if (streamAssets[h].state == STREAM_DECODED && streamAssets[h].target == NULL)
+    {
+        image = streamAssets[h].image;
+        streamAssets[h].image = (Image){0};
+        streamAssets[h].state = STREAM_READY;
+    }
+    pthread_mutex_unlock(&streamLock);
+    return image;
+}
+
+/* RGBA8 and DXT images with whole blocks can be uploaded in row slices. */
+static bool StreamCanSlice(Image image)
+{
+    if (image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        return true;
+#ifdef STREAM_COMPRESSED_SLICES
+    return image.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB && image.format <= PIXELFORMAT_COMPRESSED_DXT5_RGBA &&
+           image.width % 4 == 0 && image.height % 4 == 0;
+#else
+    return false;
+#endif
+}
+
+static void StreamUploadRows(StreamAsset *a, int y, int rows)
+{
+    Image *image = &a->image;
+    const unsigned char *pixels = (const unsigned char *)image->data + GetPixelDataSize(image->width, y, image->format);
+    if (image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    {
+        UpdateTextureRec(a->texture, (Rectangle){0, (float)y, (float)image->width, (float)rows}, pixels);
+        return;
+    }
+#ifdef STREAM_COMPRESSED_SLICES
+    unsigned int glInternalFormat, glFormat, glType;
+    rlGetGlTextureFormats(image->format, &glInternalFormat, &glFormat, &glType);
+    rlEnableTexture(a->texture.id);
+    glCompressedTexSubImage2D(STREAM_GL_TEXTURE_2D, 0, 0, y, image->width, rows, glInternalFormat,
+                              GetPixelDataSize(image->width, rows, image->format), pixels);
+    rlDisableTexture();
+#endif
+}
+
+/* Uploads decoded rows until the frame's budget (in seconds) is spent. */
+static void StreamUpdate(double budget)
+{
+    double start = GetTime();
+    for (int h = 0; h < streamAssetCount; h++)
+    {
+        StreamAsset *a = &streamAssets[h];
+        if (a->target == NULL)
+            continue;
+
+        StreamState state = StreamGetState(h);
+        if (state == STREAM_DECODED && !StreamCanSlice(a->image))
+        {
+            *a->target = LoadTextureFromImage(a->image);
+            ReleaseAssetImage(a->image);
+            a->image = (Image){0};
+            pthread_mutex_lock(&streamLock);
+            a->state = STREAM_READY;
+            pthread_mutex_unlock(&streamLock);
+            continue;
+        }
+        if (state == STREAM_DECODED)
+        {
+            a->texture.id = rlLoadTexture(NULL, a->image.width, a->image.height, a->image.format, 1);
+            a->texture.width = a->image.width;
+            a->texture.height = a->image.height;
+            a->texture.mipmaps = 1;
+            a->texture.format = a->image.format;
+            a->uploadedRows = 0;
+            pthread_mutex_lock(&streamLock);
+            a->state = STREAM_UPLOADING;
+            pthread_mutex_unlock(&streamLock);
+            state = STREAM_UPLOADING;
+        }
+        if (state != STREAM_UPLOADING)
+            continue;
+
+        while (a->uploadedRows < a->image.height)
+        {
+            int rows = STREAM_MIN_ROWS;
+            if (a->uploadedRows + rows > a->image.height)
+                rows = a->image.height - a->uploadedRows;
+            StreamUploadRows(a, a->uploadedRows, rows);
+            a->uploadedRows += rows;
+            if (GetTime() - start >= budget)
+                break;
+        }
+
+        if (a->uploadedRows >= a->image.height)
+        {
+            ReleaseAssetImage(a->image);
+            a->image = (Image){0};
+            *a->target = a->texture;
+            pthread_mutex_lock(&streamLock);
+            a->state = STREAM_READY;
+            pthread_mutex_unlock(&streamLock);
+        }
+        if (GetTime() - start >= budget)
+            return;
+    }
+}
+
+static size_t StreamTextureBytes(int h)
+{
+    if (StreamGetState(h) != STREAM_READY || streamAssets[h].target == NULL)
+        return 0;
+    Texture2D t = *streamAssets[h].target;
+    return (size_t)GetPixelDataSize(t.width, t.height, t.format);
+}
+
+/* Drops a resident texture; a later StreamRequest loads it again. */
+static void StreamUnload(int h)
+{
+    if (h < 0 || streamAssets[h].target == NULL || StreamGetState(h) != STREAM_READY)
+        return;
+    if (streamAssets[h].target->id)
+        UnloadTexture(*streamAssets[h].target);
+    *streamAssets[h].target = (Texture2D){0};
+    pthread_mutex_lock(&streamLock);
+    streamAssets[h].state = STREAM_IDLE;
+    pthread_mutex_unlock(&streamLock);
+}
+
+static void StreamShutdown(void)
+{
+    if (streamRunning)
+    {
+        pthread_mutex_lock(&streamLock);
+        streamRunning = false;
+        pthread_cond_broadcast(&streamWake);
+        pthread_mutex_unlock(&streamLock);
+        pthread_join(streamThread, NULL);
+    }
+
+    for (int h = 0; h < streamAssetCount; h++)
+    {
+        StreamAsset *a = &streamAssets[h];
+        ReleaseAssetImage(a->image);
+        if (a->state == STREAM_UPLOADING && a->texture.id)
+            UnloadTexture(a->texture);
+        memset(a, 0, sizeof(*a));
+    }
+    streamAssetCount = 0;
+    streamQueueHead = 0;
+    streamQueueTail = 0;
+}
+
+#endif
@@ -0,0 +1,476 @@
+#include "combat.h"
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_BUILDS (1 << STAGE_COUNT)
+#define MAX_WORKERS 64
+#define MAX_VALUES 256
+#define MAX_POINTS (1 << 20)
+#define MAX_TURNS 1000
+#define ROUND_BATTLES 4096
+#define STOP_Z 4.0
+#define TOP_POINTS 10
+
+typedef struct
+{
+    const char *name;
+    size_t offset;
+} SweepParam;
+
+static const SweepParam sweepParams[] = {
+    {"player_hp", offsetof(CombatParams, playerHp)},
+    {"boss_hp", offsetof(CombatParams, bossHp)},
+    {"boss_attack", offsetof(CombatParams, bossAttack)},
+    {"boss_spread", offsetof(CombatParams, bossSpread)},
+    {"armor_divisor", offsetof(CombatParams, armorDivisor)},
+    {"potion_heal", offsetof(CombatParams, potionHeal)},
+    {"bomb_min", offsetof(CombatParams, bombMin)},
+    {"bomb_max", offsetof(CombatParams, bombMax)},
+    {"sword_min", offsetof(CombatParams, swordMin)},
+    {"sword_max", offsetof(CombatParams, swordMax)},
+    {"unarmed_min", offsetof(CombatParams, unarmedMin)},
+    {"unarmed_max", offsetof(CombatParams, unarmedMax)},
+    {"coin_escape", offsetof(CombatParams, coinEscapePercent)},
+};
+#define PARAM_COUNT ((int)(sizeof(sweepParams) / sizeof(sweepParams[0])))
+
+/* One axis of the grid: a parameter and the values it takes. Parameters the
+   spec does not mention keep the game's value. */
+typedef struct
+{
+    int param;
+    int values[MAX_VALUES];
+    int count;
+} SweepAxis;
+
+typedef struct
+{
+    long long wins;
+    long long losses;
+    long long escapes;
+    long long turns;
+    long long battles;
+} BuildStats;
+
+typedef struct
+{
+    CombatParams params;
+    BuildStats builds[MAX_BUILDS];
+    double winRate;
+    bool stopped;
+    bool invalid;
+} SweepPoint;
+
+static SweepAxis axes[PARAM_COUNT];
+static int axisCount;
+static bool hasTarget;
+static double targetLow, targetHigh;
+static long long randomPoints;
+
+static ItemType builds[MAX_BUILDS][INVENTORY_SIZE];
+static int buildCount;
+static SweepPoint *points;
+static int pointCount;
+static long long battlesPerBuild = 100000;
+static uint64_t baseSeed;
+static int nextPoint;
+
+static int *ParamField(CombatParams *cp, int param)
+{
+    return (int *)((char *)cp + sweepParams[param].offset);
+}
+
+static int FindParam(const char *name)
+{
+    for (int i = 0; i < PARAM_COUNT; i++)
+    {
+        if (strcmp(sweepParams[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/* Spec lines: "param v1 v2 ...", "param start:stop:step", "target win lo hi"
+   and "random N". '#' starts a comment. */
+static bool LoadSpec(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "nao foi possivel abrir %s\n", path);
+        return false;
+    }
+
+    char line[1024];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        lineNumber++;
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+        char *word = strtok(line, " \t\r\n");
+        if (!word)
+            continue;
+
+        if (strcmp(word, "target") == 0)
+        {
+            char *what = strtok(NULL, " \t\r\n"), *lo = strtok(NULL, " \t\r\n"), *hi = strtok(NULL, " \t\r\n");
+            if (!what || strcmp(what, "win") != 0 || !lo || !hi)
+            {
+                fprintf(stderr, "%s:%d: use 'target win min max'\n", path, lineNumber);
+                fclose(f);
+                return false;
+            }
+            hasTarget = true;
+            targetLow = atof(lo);
+            targetHigh = atof(hi);
+            continue;
+        }
+        if (strcmp(word, "random") == 0)
+        {
+            char *n = strtok(NULL, " \t\r\n");
+            randomPoints = n ? atoll(n) : 0;
+            continue;
+        }
+
+        int param = FindParam(word);
+        if (param < 0)
+        {
+            fprintf(stderr, "%s:%d: parametro desconhecido '%s'\n", path, lineNumber, word);
+            fclose(f);
+            return false;
+        }
+        for (int a = 0; a < axisCount; a++)
+        {
+            if (axes[a].param == param)
+            {
+                fprintf(stderr, "%s:%d: parametro repetido '%s'\n", path, lineNumber, word);
+                fclose(f);
+                return false;
+            }
+        }
+        if (axisCount == PARAM_COUNT)
+        {
+            fprintf(stderr, "%s:%d: parametros demais\n", path, lineNumber);
+            fclose(f);
+            return false;
+        }
+        SweepAxis *axis = &axes[axisCount++];
+        axis->param = param;
+        axis->count = 0;
+
+        char *value;
+        while ((value = strtok(NULL, " \t\r\n")) != NULL)
+        {
+            int start, stop, step = 1;
+            if (sscanf(value, "%d:%d:%d", &start, &stop, &step) >= 2)
+            {
+                if (step <= 0)
+                    step = 1;
+                for (int v = start; v <= stop && axis->count < MAX_VALUES; v += step)
+                    axis->values[axis->count++] = v;
+            }
+            else if (axis->count < MAX_VALUES)
+            {
+                axis->values[axis->count++] = atoi(value);
+            }
+        }
+        if (axis->count == 0)
+        {
+            fprintf(stderr, "%s:%d: '%s' sem valores\n", path, lineNumber, word);
+            fclose(f);
+            return false;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static bool ValidParams(const CombatParams *cp)
+{
+    return cp->playerHp > 0 && cp->bossHp > 0 && cp->bossAttack > 0 && cp->bossSpread >= 0 && cp->armorDivisor > 0 &&
+           cp->potionHeal >= 0 && cp->bombMin > 0 && cp->bombMin <= cp->bombMax && cp->swordMin > 0 &&
+           cp->swordMin <= cp->swordMax && cp->unarmedMin > 0 && cp->unarmedMin <= cp->unarmedMax &&
+           cp->coinEscapePercent >= 0 && cp->coinEscapePercent <= 100;
+}
+
+/* Full grid in mixed-radix order, or randomPoints independent draws from it. */
+static bool BuildPoints(void)
+{
+    double gridSize = 1.0;
+    for (int a = 0; a < axisCount; a++)
+        gridSize *= axes[a].count;
+
+    bool sample = randomPoints > 0 && randomPoints < gridSize;
+    double wanted = sample ? (double)randomPoints : gridSize;
+    if (wanted > MAX_POINTS)
+    {
+        fprintf(stderr, "%.0f pontos; o limite e %d (use 'random N')\n", wanted, MAX_POINTS);
+        return false;
+    }
+
+    pointCount = (int)wanted;
+    points = calloc((size_t)pointCount, sizeof(SweepPoint));
+    if (!points)
+        return false;
+
+    Rng rng;
+    RngSeed(&rng, baseSeed ^ 0x5EEDull);
+    for (int i = 0; i < pointCount; i++)
+    {
+        CombatParams cp = combatDefaults;
+        long long rest = i;
+        for (int a = axisCount - 1; a >= 0; a--)
+        {
+            int pick = sample ? RngRange(&rng, 0, axes[a].count - 1) : (int)(rest % axes[a].count);
+            rest /= axes[a].count;
+            *ParamField(&cp, axes[a].param) = axes[a].values[pick];
+        }
+        points[i].params = cp;
+        points[i].invalid = !ValidParams(&cp);
+    }
+    return true;
+}
+
+/* Clearly off target: the whole z = STOP_Z interval around the mean win
+   rate lies outside [targetLow, targetHigh]. */
+static bool OffTarget(long long wins, long long battles)
+{
+    double p = (double)wins / battles;
+    double margin = STOP_Z * sqrt(p * (1.0 - p) / battles + 1e-12);
+    return p + margin < targetLow || p - margin > targetHigh;
+}
+
+/* Plays ROUND_BATTLES more battles per build until the point has
+   battlesPerBuild each, or is off target after a round. */
+static void EvaluatePoint(int index)
+{
+    SweepPoint *pt = &points[index];
+    if (pt->invalid)
+        return;
+    const CombatParams *cp = &pt->params;
+
+    uint64_t mix = baseSeed ^ ((uint64_t)index * 0xD1B54A32D192ED03ull);
+    Rng rng;
+    RngSeed(&rng, RngSplitMix(&mix));
+
+    long long done = 0;
+    while (done < battlesPerBuild)
+    {
+        long long round = battlesPerBuild - done < ROUND_BATTLES ? battlesPerBuild - done : ROUND_BATTLES;
+        long long wins = 0, battles = 0;
+        for (int b = 0; b < buildCount; b++)
+        {
+            BuildStats *stats = &pt->builds[b];
+            for (long long n = 0; n < round; n++)
+            {
+                Battle battle;
+                BattleInitWith(cp, &battle, builds[b]);
+                while (battle.outcome == BATTLE_ONGOING && battle.turns < MAX_TURNS)
+                {
+                    if (!BattlePlayerActWith(cp, &battle, CombatHeuristicActionWith(cp, &battle), &rng))
+                        BattlePlayerActWith(cp, &battle, ACTION_ATTACK, &rng);
+                    if (battle.outcome != BATTLE_ONGOING)
+                        break;
+                    BattleBossActWith(cp, &battle, &rng);
+                }
+
+                if (battle.outcome == BATTLE_WON)
+                    stats->wins++;
+                else if (battle.outcome == BATTLE_ESCAPED)
+                    stats->escapes++;
+                else
+                    stats->losses++;
+                stats->turns += battle.turns;
+                stats->battles++;
+            }
+            wins += stats->wins;
+            battles += stats->battles;
+        }
+        done += round;
+
+        pt->winRate = (double)wins / battles;
+        if (hasTarget && done < battlesPerBuild && OffTarget(wins, battles))
+        {
+            pt->stopped = true;
+            return;
+        }
+    }
+}
+
+static void *WorkerMain(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        int index = __atomic_fetch_add(&nextPoint, 1, __ATOMIC_RELAXED);
+        if (index >= pointCount)
+            return NULL;
+        EvaluatePoint(index);
+    }
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void BuildName(int b, char *name, size_t size)
+{
+    name[0] = '\0';
+    for (int s = 0; s < INVENTORY_SIZE; s++)
+    {
+        if (s > 0)
+            strncat(name, "+", size - strlen(name) - 1);
+        strncat(name, GetItemShortName(builds[b][s]), size - strlen(name) - 1);
+    }
+}
+
+static bool WriteResults(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return false;
+    for (int p = 0; p < PARAM_COUNT; p++)
+        fprintf(f, "%s,", sweepParams[p].name);
+    fprintf(f, "build,vitoria,derrota,fuga,turnos,batalhas,parado\n");
+
+    for (int i = 0; i < pointCount; i++)
+    {
+        SweepPoint *pt = &points[i];
+        if (pt->invalid)
+            continue;
+        for (int b = 0; b < buildCount; b++)
+        {
+            const BuildStats *s = &pt->builds[b];
+            char name[64];
+            BuildName(b, name, sizeof(name));
+            for (int p = 0; p < PARAM_COUNT; p++)
+                fprintf(f, "%d,", *ParamField(&pt->params, p));
+            double n = s->battles ? (double)s->battles : 1.0;
+            fprintf(f, "%s,%.5f,%.5f,%.5f,%.3f,%lld,%d\n", name, s->wins / n, s->losses / n, s->escapes / n, s->turns / n,
+                    s->battles, pt->stopped ? 1 : 0);
+        }
+    }
+    bool ok = ferror(f) == 0;
+    return (fclose(f) == 0) && ok;
+}
+
+static double TargetDistance(const SweepPoint *pt)
+{
+    if (pt->winRate < targetLow)
+        return targetLow - pt->winRate;
+    if (pt->winRate > targetHigh)
+        return pt->winRate - targetHigh;
+    return fabs(pt->winRate - (targetLow + targetHigh) / 2) - 1.0;
+}
+
+static int CompareDistance(const void *a, const void *b)
+{
+    double x = TargetDistance(&points[*(const int *)a]), y = TargetDistance(&points[*(const int *)b]);
+    return (x > y) - (x < y);
+}
+
+static void PrintBest(void)
+{
+    int *order = malloc(sizeof(int) * (size_t)pointCount);
+    int count = 0;
+    for (int i = 0; i < pointCount; i++)
+    {
+        if (!points[i].invalid && !points[i].stopped)
+            order[count++] = i;
+    }
+    qsort(order, (size_t)count, sizeof(int), CompareDistance);
+
+    printf("\nPontos mais proximos do alvo (vitoria media entre %.2f e %.2f):\n", targetLow, targetHigh);
+    for (int k = 0; k < count && k < TOP_POINTS; k++)
+    {
+        SweepPoint *pt = &points[order[k]];
+        printf("  vitoria %6.2f%% ", 100.0 * pt->winRate);
+        for (int a = 0; a < axisCount; a++)
+            printf(" %s=%d", sweepParams[axes[a].param].name, *ParamField(&pt->params, axes[a].param));
+        printf("\n");
+    }
+    free(order);
+}
+
+int main(int argc, char **argv)
+{
+    const char *specPath = NULL;
+    const char *outPath = "sweep.csv";
+    int workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    baseSeed = (uint64_t)time(NULL);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--battles") == 0 && i + 1 < argc)
+            battlesPerBuild = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            workerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            baseSeed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (!specPath && argv[i][0] != '-')
+            specPath = argv[i];
+        else
+            specPath = NULL, i = argc;
+    }
+    if (!specPath)
+    {
+        fprintf(stderr, "uso: %s spec.txt [--battles N] [--threads N] [--seed S] [--out sweep.csv]\n", argv[0]);
+        return 1;
+    }
+    if (battlesPerBuild < 1)
+        battlesPerBuild = 1;
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > MAX_WORKERS)
+        workerCount = MAX_WORKERS;
+
+    if (!LoadSpec(specPath) || !BuildPoints())
+        return 1;
+    buildCount = CombatEnumerateBuilds(builds, MAX_BUILDS);
+
+    double start = Now();
+    pthread_t threads[MAX_WORKERS];
+    for (int i = 1; i < workerCount; i++)
+        pthread_create(&threads[i], NULL, WorkerMain, NULL);
+    WorkerMain(NULL);
+    for (int i = 1; i < workerCount; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed = Now() - start;
+
+    int stopped = 0, invalid = 0;
+    long long battles = 0;
+    for (int i = 0; i < pointCount; i++)
+    {
+        stopped += points[i].stopped;
+        invalid += points[i].invalid;
+        for (int b = 0; b < buildCount; b++)
+            battles += points[i].builds[b].battles;
+    }
+
+    printf("%d pontos (%d parados cedo, %d invalidos), %lld batalhas em %.2f s com %d threads (%.2f M batalhas/s)\n", pointCount,
+           stopped, invalid, battles, elapsed, workerCount, battles / elapsed / 1e6);
+    if (hasTarget)
+        PrintBest();
+
+    if (!WriteResults(outPath))
+    {
+        fprintf(stderr, "nao foi possivel gravar %s\n", outPath);
+        return 1;
+    }
+    printf("Resultados em %s\n", outPath);
+    free(points);
+    return 0;
+}
@@ -0,0 +1,139 @@
+#ifndef TEXMGR_H
+#define TEXMGR_H
+
+#include "raylib.h"
+#include "stream.h"
+#include <stddef.h>
+
+#define TEXMGR_MAX_TEXTURES STREAM_MAX_ASSETS
+#define TEXMGR_DEFAULT_BUDGET (16u * 1024u * 1024u)
+
+/* Residency on top of the streamer: scenes hold references on the textures
+   they need. An unreferenced texture the scene has retired (a stage already
+   passed) is unloaded right away; the others stay cached until resident
+   bytes exceed the budget, least recently used first. Either kind streams
+   back in on the next acquire. */
+typedef struct
+{
+    int stream;
+    int refs;
+    bool retired;
+    double lastUse;
+} ManagedTexture;
+
+static ManagedTexture managedTextures[TEXMGR_MAX_TEXTURES];
+static int managedTextureCount = 0;
+static size_t texMgrBudget = TEXMGR_DEFAULT_BUDGET;
+
+static int TexMgrRegister(const char *name, Texture2D *target, int maxWidth, int maxHeight)
+{
+    if (managedTextureCount >= TEXMGR_MAX_TEXTURES)
+        return -1;
+    int h = managedTextureCount++;
+    managedTextures[h].stream = StreamRegister(name, target, maxWidth, maxHeight);
+    managedTextures[h].refs = 0;
+    managedTextures[h].retired = false;
+    managedTextures[h].lastUse = 0.0;
+    return h;
+}
+
+static void TexMgrSetBudget(size_t bytes)
+{
+    texMgrBudget = bytes;
+}
+
+static void TexMgrAcquire(int h)
+{
+    if (h < 0)
+        return;
+    managedTextures[h].refs++;
+    managedTextures[h].retired = false;
+    managedTextures[h].lastUse = GetTime();
+    StreamRequest(managedTextures[h].stream);
+}
+
+static void TexMgrRelease(int h)
+{
+    if (h < 0 || managedTextures[h].refs == 0)
+        return;
+    managedTextures[h].refs--;
+    managedTextures[h].lastUse = GetTime();
+}
+
+/* Marks a texture the scene cannot ask for again until it is re-acquired. */
+static void TexMgrRetire(int h)
+{
+    if (h >= 0)
+        managedTextures[h].retired = true;
+}
+
+/* Keeps a held reference in sync with whether the scene still wants it. */
+static void TexMgrHold(int h, bool *held, bool wanted)
+{
+    if (wanted && !*held)
+        TexMgrAcquire(h);
+    else if (!wanted && *held)
+        TexMgrRelease(h);
+    *held = wanted;
+}
+
+static size_t TexMgrResidentBytes(void)
+{
+    size_t total = 0;
+    for (int h = 0; h < managedTextureCount; h++)
+        total += StreamTextureBytes(managedTextures[h].stream);
+    return total;
+}
+
+static void TexMgrUpdate(void)
+{
+    double now = GetTime();
+    for (int h = 0; h < managedTextureCount; h++)
+    {
+        ManagedTexture *m = &managedTextures[h];
+        if (m->refs > 0)
+            m->lastUse = now;
+        else if (m->retired && StreamTextureBytes(m->stream) > 0)
+        {
+            TraceLog(LOG_INFO, "TEXMGR: descartando %s (%zu KB), nao sera mais usada", streamAssets[m->stream].name,
+                     StreamTextureBytes(m->stream) / 1024);
+            StreamUnload(m->stream);
+        }
+    }
+
+    size_t resident = TexMgrResidentBytes();
+    while (resident > texMgrBudget)
+    {
+        int victim = -1;
+        for (int h = 0; h < managedTextureCount; h++)
+        {
+            if (managedTextures[h].refs > 0 || StreamTextureBytes(managedTextures[h].stream) == 0)
+                continue;
+            if (victim < 0 || managedTextures[h].lastUse < managedTextures[victim].lastUse)
+                victim = h;
+        }
+        if (victim < 0)
+            break;
+
+        size_t bytes = StreamTextureBytes(managedTextures[victim].stream);
+        TraceLog(LOG_INFO, "TEXMGR: liberando %s (%zu KB)", streamAssets[managedTextures[victim].stream].name, bytes / 1024);
+        StreamUnload(managedTextures[victim].stream);
+        resident -= bytes;
+    }
+}
+
+static void TexMgrReport(void)
+{
+    TraceLog(LOG_INFO, "TEXMGR: %-24s %11s %6s %5s %s", "textura", "tamanho", "KB", "refs", "estado");
+    for (int h = 0; h < managedTextureCount; h++)
+    {
+        const StreamAsset *a = &streamAssets[managedTextures[h].stream];
+        size_t bytes = StreamTextureBytes(managedTextures[h].stream);
+        Texture2D t = bytes ? *a->target : (Texture2D){0};
+        const char *state = managedTextures[h].refs > 0 ? "em uso" : managedTextures[h].retired ? "descartada" : bytes ? "cache" : "-";
+        TraceLog(LOG_INFO, "TEXMGR: %-24s %5dx%-5d %6zu %5d %s", a->name, t.width, t.height, bytes / 1024, managedTextures[h].refs, state);
+    }
+    TraceLog(LOG_INFO, "TEXMGR: residente %zu KB de %zu KB", TexMgrResidentBytes() / 1024, texMgrBudget / 1024);
+}
+
+#endif